@@ -0,0 +1,79 @@
+#ifndef BENCHMARK_COMUN_H
+#define BENCHMARK_COMUN_H
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Funciones auxiliares que comparten los programas de medición
+ * (hash_benchmark.c y hash_*_benchmark.c). Son static inline para que cada
+ * programa se siga compilando aparte, sin otro archivo .c.
+ */
+
+// Source: https://prng.di.unimi.it/splitmix64.c
+static inline uint64_t mezclar(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/* Devuelve el siguiente número de la secuencia que empieza en *estado. Con
+ * varios hilos conviene que cada uno tenga su propio estado, para no
+ * compartir una línea de caché.
+ */
+static inline uint64_t aleatorio(uint64_t *estado) {
+    *estado += 0x9e3779b97f4a7c15ULL;
+    return mezclar(*estado);
+}
+
+static inline uint64_t ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/* Escribe en clave, de a lo sumo 'largo' bytes contando el '\0', la clave
+ * de 16 dígitos hexadecimales que corresponde a id. Claves de ids distintos
+ * son distintas y no siguen ningún orden.
+ */
+static inline void escribir_clave_aleatoria(char *clave, size_t largo, uint64_t id) {
+    snprintf(clave, largo, "%016llx", (unsigned long long) mezclar(id));
+}
+
+/* Leen en *valor el número de 'texto', para los argumentos de la línea de
+ * comandos. Devuelven false si el texto no es un entero sin signo que entre
+ * en el tipo.
+ */
+static inline bool leer_entero(const char *texto, uint64_t *valor) {
+    char *fin;
+    errno = 0;
+    unsigned long long numero = strtoull(texto, &fin, 10);
+    if (*texto == '\0' || *texto == '-' || *fin != '\0' || errno == ERANGE) return false;
+    *valor = numero;
+    return true;
+}
+
+static inline bool leer_numero(const char *texto, size_t *valor) {
+    uint64_t numero;
+    if (!leer_entero(texto, &numero) || (size_t) numero != numero) return false;
+    *valor = (size_t) numero;
+    return true;
+}
+
+// Devuelve false si el texto no es un número real.
+static inline bool leer_real(const char *texto, double *valor) {
+    char *fin;
+    *valor = strtod(texto, &fin);
+    return *texto != '\0' && *fin == '\0';
+}
+
+// La capacidad tiene que ser una potencia de dos para que la tabla no la redondee.
+static inline bool capacidad_valida(size_t capacidad) {
+    return capacidad >= 64 && (capacidad & (capacidad - 1)) == 0;
+}
+
+#endif  // BENCHMARK_COMUN_H
@@ -1,210 +1,1795 @@
 #include "hash.h"
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "stdio.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef HASH_ESTADISTICAS
+#include <time.h>
+#endif
 
 
-#define CAPACIDAD_INICIAL 20
+// Las capacidades son potencias de dos, así la posición se obtiene con una
+// máscara en lugar de una división. Estos son los valores por omisión de
+// hash_opciones_t.
+#define CAPACIDAD_INICIAL 32
 #define VALOR_CARGA 0.7
+// Robin Hood acota la varianza de los sondeos, así que tolera más carga.
+#define VALOR_CARGA_ROBIN_HOOD 0.9
+#define FACTOR_CRECIMIENTO 2
+// Al borrar, la tabla se achica a la mitad si la carga baja de la que queda
+// justo después de crecer dividida por este factor, así no vuelve a crecer
+// enseguida. Con el crecimiento por omisión es la máxima dividida por 4.
+#define FACTOR_ACHICAR 2
 
-typedef enum estado {
-    VACIO, OCUPADO, BORRADO
-} estado_t;
+// Cada campo de la tabla tiene un byte de control en un arreglo aparte: VACIO,
+// BORRADO, o una etiqueta de 7 bits del hash de la clave si está ocupado. Así
+// el sondeo recorre bytes contiguos y solo compara claves si la etiqueta coincide.
+#define VACIO 0x80
+#define BORRADO 0xFE
+#define TAMANIO_GRUPO 16
+// Claves que hash_obtener_lote hashea y precarga antes de empezar a buscarlas.
+#define TAMANIO_LOTE 16
+// Con redimensión incremental, posiciones de la tabla vieja que mueve cada
+// operación que modifica el hash.
+#define MIGRAR_POR_OPERACION 32
 
+// Arena de claves: bloques de este tamaño, y listas de libres por tamaño
+// (en múltiplos de 8 bytes) para las claves de hasta 8 * CLASES_ARENA bytes.
+#define TAMANIO_BLOQUE_ARENA 65536
+#define CLASES_ARENA 32
+
+// Las claves de hasta LARGO_CLAVE_CORTA bytes se guardan dentro del campo.
+// El último byte indica cuánto lugar sobra (y hace de '\0' si no sobra nada),
+// o vale CLAVE_LARGA si la clave está afuera y se guardan su puntero y largo.
+#define LARGO_CLAVE_CORTA 15
+#define CLAVE_LARGA 0xFF
+
+typedef union clave{
+  struct {
+    char* puntero;
+    uint32_t largo;
+  } larga;
+  char corta[LARGO_CLAVE_CORTA + 1];
+} clave_t;
+
+// 32 bytes: dos campos por línea de caché.
 typedef struct campo{
-  char* clave;
+  clave_t clave;
   void* valor;
-  estado_t estado;
+  unsigned long hash; // Se guarda para no recalcularlo al redimensionar ni comparar claves de más.
 } campo_t;
 
+// La mayor potencia de dos de campos cuya tabla se puede medir en un size_t
+// (campo_t ocupa una potencia de dos). Más que esto no se pide.
+#define CAPACIDAD_MAXIMA (((size_t) 1 << (sizeof(size_t) * 8 - 1)) / sizeof(campo_t))
+
+typedef struct bloque{
+  struct bloque* siguiente;
+  size_t usado;
+  size_t tamanio;
+  char datos[];
+} bloque_t;
+
+typedef struct arena{
+  bloque_t* bloques;
+  void* libres[CLASES_ARENA];
+} arena_t;
+
+#ifdef HASH_ESTADISTICAS
+// Contadores de uso del hash, ver hash_estadisticas.
+typedef struct contadores{
+  size_t aciertos;
+  size_t fallos;
+  size_t sondeos[HASH_BUCKETS_ESTADISTICAS];
+  size_t redimensiones;
+  size_t bytes_movidos;
+  uint64_t ns_redimensionando;
+} contadores_t;
+#endif
+
 struct hash{
   size_t capacidad;
   size_t cantidad;
+  size_t borrados;
+  hash_motor_t motor;
+  hash_funcion_t funcion;
+  double carga_maxima;
+  double carga_minima;
+  size_t capacidad_minima; // La inicial: al achicar no se baja de ella.
+  size_t capacidad_reservada; // La de hash_reservar: tampoco se baja de ella, hasta compactar.
+  size_t factor_crecimiento;
+  // Las cargas como cantidades para la capacidad actual, así guardar y borrar
+  // no hacen cuentas con punto flotante: la tabla crece cuando elementos más
+  // borrados llegan a umbral_crecer, y se achica si los elementos bajan de
+  // umbral_achicar.
+  size_t umbral_crecer;
+  size_t umbral_achicar;
   hash_destruir_dato_t funcion_destruccion;
+  // Con claves de un tipo propio hashear no es NULL y los campos guardan
+  // como clave larga, de largo 0, el puntero que devuelve copiar.
+  hash_tipo_clave_t tipo;
   campo_t* tabla;
+  unsigned char* control;
+  arena_t* arena; // NULL si cada clave se pide con malloc.
+  // Redimensión incremental: mientras vieja no es NULL, sus campos desde la
+  // posición migrados en adelante siguen siendo parte del hash.
+  bool incremental;
+  campo_t* vieja;
+  unsigned char* control_viejo;
+  size_t capacidad_vieja;
+  size_t migrados;
+  // Tabla mapeada con hash_cargar_mmap: de solo lectura, y los punteros de
+  // sus campos son desplazamientos desde base. En las demás base vale 0.
+  void* mapa;
+  size_t largo_mapa;
+  uintptr_t base;
+#ifdef HASH_ESTADISTICAS
+  contadores_t contadores;
+#endif
 };
 
+/* Con HASH_ESTADISTICAS el hash lleva contadores de uso; sin, estas macros no
+ * generan código. Las búsquedas reciben el hash const y pueden correr en
+ * varios hilos a la vez (como en hash_concurrente), así que los contadores
+ * se suman de forma atómica.
+ */
+#ifdef HASH_ESTADISTICAS
+static uint64_t reloj_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+#define SUMAR(hash, contador, n) \
+    __atomic_fetch_add(&((hash_t *) (hash))->contadores.contador, (n), __ATOMIC_RELAXED)
+#define EMPEZAR_MEDICION(inicio) uint64_t inicio = reloj_ns()
+#define TERMINAR_MEDICION(hash, inicio) SUMAR(hash, ns_redimensionando, reloj_ns() - (inicio))
+#define INICIAR_CONTADORES(hash) memset(&(hash)->contadores, 0, sizeof(contadores_t))
+#else
+#define SUMAR(hash, contador, n) ((void) 0)
+#define EMPEZAR_MEDICION(inicio) ((void) 0)
+#define TERMINAR_MEDICION(hash, inicio) ((void) 0)
+#define INICIAR_CONTADORES(hash) ((void) 0)
+#endif
+
 struct hash_iter{
   const hash_t* hash;
-  campo_t campo_act;
   size_t posicion;
 };
 
-// Source: http://www.cse.yorku.ca/~oz/hash.html    
-unsigned long hash_f(char *str){
-    
+// Source: http://www.cse.yorku.ca/~oz/hash.html
+unsigned long hash_f(const char *str, size_t largo){
+
     unsigned long hash = 5381;
-    int c;
 
-    while ((c = *str++)){
+    for (size_t i = 0; i < largo; i++){
+        int c = str[i];
         hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
     }
 
     return hash;
 }
 
+/* Basada en wyhash (https://github.com/wangyi-fudan/wyhash): lee la clave de
+ * a 8 bytes y mezcla cada par de palabras con una multiplicación de 128 bits
+ * plegada a 64, así todos los bits de la clave afectan a los bits bajos que
+ * usa la máscara.
+ */
+#define WY_0 0xa0761d6478bd642fULL
+#define WY_1 0xe7037ed1a0b428dbULL
+
+static uint64_t mezclar(uint64_t a, uint64_t b) {
+    __uint128_t r = (__uint128_t) a * b;
+    return (uint64_t) r ^ (uint64_t) (r >> 64);
+}
+
+static uint64_t leer64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t leer32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
 
-void crear_campo(campo_t* tabla, size_t cantidad){
-    for (int i = 0; i < cantidad; i++) {
-        campo_t campo;
-        campo.clave = NULL;
-        campo.valor = NULL;
-        campo.estado = VACIO;
-        tabla[i] = campo;
+static uint64_t hash_wy(const char *clave, size_t largo) {
+    const unsigned char *p = (const unsigned char *) clave;
+    uint64_t semilla = WY_0;
+    uint64_t a, b;
+
+    if (largo <= 16) {
+        if (largo >= 4) {
+            size_t medio = (largo >> 3) << 2;
+            a = (leer32(p) << 32) | leer32(p + medio);
+            b = (leer32(p + largo - 4) << 32) | leer32(p + largo - 4 - medio);
+        } else if (largo > 0) {
+            a = ((uint64_t) p[0] << 16) | ((uint64_t) p[largo >> 1] << 8) | p[largo - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t resto = largo;
+        while (resto > 16) {
+            semilla = mezclar(leer64(p) ^ WY_1, leer64(p + 8) ^ semilla);
+            p += 16;
+            resto -= 16;
+        }
+        a = leer64(p + resto - 16);
+        b = leer64(p + resto - 8);
     }
+    return mezclar(WY_1 ^ largo, mezclar(a ^ WY_1, b ^ semilla));
 }
 
-hash_t *hash_crear(hash_destruir_dato_t destruir_dato){
+
+/* ******************************************************************
+ *                         ARENA DE CLAVES
+ * *****************************************************************/
+
+static arena_t *arena_crear(void) {
+    return calloc(1, sizeof(arena_t));
+}
+
+static bloque_t *arena_agregar_bloque(arena_t *arena, size_t tamanio) {
+    bloque_t *bloque = malloc(sizeof(bloque_t) + tamanio);
+    if (!bloque) return NULL;
+    bloque->usado = 0;
+    bloque->tamanio = tamanio;
+    bloque->siguiente = arena->bloques;
+    arena->bloques = bloque;
+    return bloque;
+}
+
+/* Devuelve lugar para 'largo' bytes. Primero reutiliza una clave borrada del
+ * mismo tamaño; si no, avanza en el último bloque. Las claves que no entran en
+ * un bloque común tienen uno propio, que no se reutiliza hasta destruir.
+ */
+static char *arena_pedir(arena_t *arena, size_t largo) {
+    size_t tamanio = (largo + 7) & ~(size_t) 7;
+    size_t clase = tamanio / 8 - 1;
+
+    if (clase < CLASES_ARENA && arena->libres[clase]) {
+        char *lugar = arena->libres[clase];
+        memcpy(&arena->libres[clase], lugar, sizeof(void*));
+        return lugar;
+    }
+
+    if (tamanio > TAMANIO_BLOQUE_ARENA / 4) {
+        bloque_t *propio = arena_agregar_bloque(arena, tamanio);
+        if (!propio) return NULL;
+        propio->usado = tamanio;
+        // Queda detrás del bloque en uso para que este se siga llenando.
+        if (propio->siguiente) {
+            arena->bloques = propio->siguiente;
+            propio->siguiente = arena->bloques->siguiente;
+            arena->bloques->siguiente = propio;
+        }
+        return propio->datos;
+    }
+
+    bloque_t *bloque = arena->bloques;
+    if (!bloque || bloque->tamanio - bloque->usado < tamanio) {
+        bloque = arena_agregar_bloque(arena, TAMANIO_BLOQUE_ARENA);
+        if (!bloque) return NULL;
+    }
+    char *lugar = bloque->datos + bloque->usado;
+    bloque->usado += tamanio;
+    return lugar;
+}
+
+// Encadena un lugar de 'largo' bytes en la lista de libres de su tamaño.
+static void arena_devolver(arena_t *arena, char *lugar, size_t largo) {
+    size_t clase = ((largo + 7) & ~(size_t) 7) / 8 - 1;
+    if (clase >= CLASES_ARENA) return;
+    memcpy(lugar, &arena->libres[clase], sizeof(void*));
+    arena->libres[clase] = lugar;
+}
+
+static void arena_destruir(arena_t *arena) {
+    while (arena->bloques) {
+        bloque_t *siguiente = arena->bloques->siguiente;
+        free(arena->bloques);
+        arena->bloques = siguiente;
+    }
+    free(arena);
+}
+
+// Las copias terminan en '\0' para que las claves de texto se puedan leer como tales.
+static char *copiar_clave(hash_t *hash, const char *clave, size_t largo) {
+    char *copia = hash->arena ? arena_pedir(hash->arena, largo + 1) : malloc(largo + 1);
+    if (!copia) return NULL;
+    memcpy(copia, clave, largo);
+    copia[largo] = '\0';
+    return copia;
+}
+
+static void liberar_clave(hash_t *hash, char *clave, size_t largo) {
+    if (hash->arena) arena_devolver(hash->arena, clave, largo + 1);
+    else free(clave);
+}
+
+/* ******************************************************************
+ *                              TABLA
+ * *****************************************************************/
+
+static bool ocupado(unsigned char control) {
+    return control < VACIO;
+}
+
+/* Devuelve un bit por cada posición ocupada entre pos y pos + 63, sin pasar
+ * de fin. Los bytes de control ya son un mapa de ocupación: una posición
+ * está ocupada si su bit alto está apagado, así que con SSE2 se leen 16
+ * posiciones por instrucción y las tablas con pocos elementos se recorren
+ * de a 64 posiciones vacías por vez.
+ */
+static uint64_t ocupados_desde(const unsigned char *control, size_t pos, size_t fin) {
+    size_t largo = fin - pos < 64 ? fin - pos : 64;
+    uint64_t mascara = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + TAMANIO_GRUPO <= largo; i += TAMANIO_GRUPO) {
+        __m128i grupo = _mm_loadu_si128((const __m128i*) &control[pos + i]);
+        uint64_t libres = (unsigned) _mm_movemask_epi8(grupo);
+        mascara |= (~libres & 0xFFFF) << i;
+    }
+#endif
+    for (; i < largo; i++) {
+        if (ocupado(control[pos + i])) mascara |= 1ULL << i;
+    }
+    return mascara;
+}
+
+// Devuelve la primera posición ocupada de control entre pos y fin, o fin si no hay.
+static size_t siguiente_en(const unsigned char *control, size_t pos, size_t fin) {
+    for (; pos < fin; pos += 64) {
+        uint64_t mascara = ocupados_desde(control, pos, fin);
+        if (mascara) return pos + (size_t) __builtin_ctzll(mascara);
+    }
+    return fin;
+}
+
+// Bucket de n en los histogramas de hash_estadisticas_t.
+static size_t bucket_estadisticas(size_t n) {
+    size_t bucket = 0;
+    for (; n > 0 && bucket < HASH_BUCKETS_ESTADISTICAS - 1; n >>= 1) bucket++;
+    return bucket;
+}
+
+// Los 7 bits altos del hash luego de mezclarlo, para que dependan de toda la clave.
+static unsigned char etiqueta(unsigned long hash) {
+    return (unsigned char) ((hash * 0x9E3779B97F4A7C15ULL) >> 57);
+}
+
+void crear_campo(campo_t* tabla, unsigned char* control, size_t cantidad){
+    memset(tabla, 0, cantidad * sizeof(campo_t));
+    memset(control, VACIO, cantidad);
+}
+
+static bool clave_corta(const campo_t *campo) {
+    return (unsigned char) campo->clave.corta[LARGO_CLAVE_CORTA] != CLAVE_LARGA;
+}
+
+static const char *ver_clave(const hash_t *hash, const campo_t *campo) {
+    if (clave_corta(campo)) return campo->clave.corta;
+    return (const char *) (hash->base + (uintptr_t) campo->clave.larga.puntero);
+}
+
+static void *ver_valor(const hash_t *hash, const campo_t *campo) {
+    if (!campo->valor) return NULL;
+    return (void *) (hash->base + (uintptr_t) campo->valor);
+}
+
+static size_t largo_clave(const campo_t *campo) {
+    if (clave_corta(campo)) return LARGO_CLAVE_CORTA - (unsigned char) campo->clave.corta[LARGO_CLAVE_CORTA];
+    return campo->clave.larga.largo;
+}
+
+static bool claves_propias(const hash_t *hash) {
+    return hash->tipo.hashear != NULL;
+}
+
+// Copia la clave dentro del campo si es corta, o fuera de la tabla si no.
+static bool guardar_clave(hash_t *hash, campo_t *campo, const char *clave, size_t largo) {
+    if (claves_propias(hash)) {
+        campo->clave.larga.puntero = hash->tipo.copiar ? hash->tipo.copiar(clave) : (char *) clave;
+        campo->clave.larga.largo = 0;
+        campo->clave.corta[LARGO_CLAVE_CORTA] = (char) CLAVE_LARGA;
+        return campo->clave.larga.puntero != NULL;
+    }
+    if (largo <= LARGO_CLAVE_CORTA) {
+        memcpy(campo->clave.corta, clave, largo);
+        campo->clave.corta[largo] = '\0';
+        campo->clave.corta[LARGO_CLAVE_CORTA] = (char) (LARGO_CLAVE_CORTA - largo);
+        return true;
+    }
+    if (largo > UINT32_MAX) return false;
+    campo->clave.larga.puntero = copiar_clave(hash, clave, largo);
+    campo->clave.larga.largo = (uint32_t) largo;
+    campo->clave.corta[LARGO_CLAVE_CORTA] = (char) CLAVE_LARGA;
+    return campo->clave.larga.puntero != NULL;
+}
+
+// Libera la copia de la clave del campo, si está fuera de la tabla.
+static void soltar_clave(hash_t *hash, campo_t *campo) {
+    if (clave_corta(campo)) return;
+    if (!claves_propias(hash)) liberar_clave(hash, campo->clave.larga.puntero, campo->clave.larga.largo);
+    else if (hash->tipo.liberar) hash->tipo.liberar(campo->clave.larga.puntero);
+}
+
+/* Los hashes de las claves propias se mezclan porque la posición sale de sus
+ * bits bajos, y funciones como la identidad para enteros los repiten mucho.
+ */
+static unsigned long calcular_hash(const hash_t *hash, const char *clave, size_t largo) {
+    if (claves_propias(hash)) return (unsigned long) mezclar(hash->tipo.hashear(clave) ^ WY_0, WY_1);
+    if (hash->funcion == HASH_FUNCION_DJB2) return hash_f(clave, largo);
+    return (unsigned long) hash_wy(clave, largo);
+}
+
+// Cuántas posiciones está el campo guardado en pos después de la original.
+static size_t distancia_a_origen(unsigned long h, size_t pos, size_t capacidad) {
+    return (pos - h) & (capacidad - 1);
+}
+
+/* Las capacidades que desbordan al multiplicarlas por el factor de
+ * crecimiento, al ser potencias de dos, llegan como 0.
+ */
+static bool crear_tabla(size_t capacidad, campo_t** tabla, unsigned char** control){
+    if(capacidad == 0 || capacidad > CAPACIDAD_MAXIMA) return false;
+    *tabla = malloc(capacidad * sizeof(campo_t));
+    *control = malloc(capacidad);
+    if(!*tabla || !*control){
+        free(*tabla);
+        free(*control);
+        return false;
+    }
+    crear_campo(*tabla, *control, capacidad);
+    return true;
+}
+
+static size_t techo(double x) {
+    size_t n = (size_t) x;
+    return (double) n < x ? n + 1 : n;
+}
+
+// Se llama cada vez que cambia la capacidad. Siempre queda al menos una
+// posición vacía, que es donde terminan los sondeos de las claves que no están.
+static void actualizar_umbrales(hash_t *hash) {
+    hash->umbral_crecer = techo((double) hash->capacidad * hash->carga_maxima);
+    if (hash->umbral_crecer >= hash->capacidad) hash->umbral_crecer = hash->capacidad - 1;
+    hash->umbral_achicar = techo((double) hash->capacidad * hash->carga_minima);
+}
+
+// Completa los valores por omisión de las opciones y dice si son válidas.
+static bool leer_opciones(hash_t *hash, const hash_opciones_t *opciones) {
+    hash->factor_crecimiento = opciones->factor_crecimiento ? opciones->factor_crecimiento : FACTOR_CRECIMIENTO;
+    hash->carga_maxima = opciones->carga_maxima;
+    if (hash->carga_maxima == 0) {
+        hash->carga_maxima = opciones->motor == HASH_MOTOR_ROBIN_HOOD ? VALOR_CARGA_ROBIN_HOOD : VALOR_CARGA;
+    }
+    hash->carga_minima = opciones->carga_minima;
+    if (hash->carga_minima == 0) {
+        hash->carga_minima = hash->carga_maxima / (double) hash->factor_crecimiento / FACTOR_ACHICAR;
+    }
+    hash->capacidad_minima = 2;
+    hash->capacidad_reservada = 0;
+    size_t pedida = opciones->capacidad_inicial ? opciones->capacidad_inicial : CAPACIDAD_INICIAL;
+    if (pedida > CAPACIDAD_MAXIMA) return false;
+    while (hash->capacidad_minima < pedida) hash->capacidad_minima *= 2;
+
+    bool potencia_de_dos = (hash->factor_crecimiento & (hash->factor_crecimiento - 1)) == 0;
+    return hash->factor_crecimiento >= 2 && potencia_de_dos && hash->carga_maxima > 0 && hash->carga_maxima < 1 &&
+           hash->carga_minima > 0 && hash->carga_minima < hash->carga_maxima / (double) hash->factor_crecimiento;
+}
+
+hash_t *hash_crear_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones){
+    // Las claves propias no se copian con la arena.
+    if(opciones->claves_en_arena && opciones->tipo_clave) return NULL;
     hash_t *hash = malloc(sizeof(hash_t));
     if(!hash) return NULL;
-
-    hash->tabla = malloc(CAPACIDAD_INICIAL * sizeof(campo_t));
-    if(!hash->tabla){
+    if(!leer_opciones(hash, opciones)){
         free(hash);
         return NULL;
     }
 
-    crear_campo(hash->tabla,CAPACIDAD_INICIAL);
+    hash->arena = NULL;
+    hash->tipo = opciones->tipo_clave ? *opciones->tipo_clave : (hash_tipo_clave_t) { NULL };
+    if(opciones->claves_en_arena){
+        hash->arena = arena_crear();
+        if(!hash->arena){
+            free(hash);
+            return NULL;
+        }
+    }
+
+    if(!crear_tabla(hash->capacidad_minima, &hash->tabla, &hash->control)){
+        if(hash->arena) arena_destruir(hash->arena);
+        free(hash);
+        return NULL;
+    }
 
     hash->cantidad = 0;
-    hash->capacidad = CAPACIDAD_INICIAL;
+    hash->borrados = 0;
+    hash->capacidad = hash->capacidad_minima;
+    hash->motor = opciones->motor;
+    hash->funcion = opciones->funcion;
+    hash->incremental = opciones->redimension_incremental;
+    hash->vieja = NULL;
+    hash->control_viejo = NULL;
+    hash->capacidad_vieja = 0;
+    hash->migrados = 0;
+    hash->mapa = NULL;
+    hash->largo_mapa = 0;
+    hash->base = 0;
+    actualizar_umbrales(hash);
     hash->funcion_destruccion = destruir_dato;
+    INICIAR_CONTADORES(hash);
     return hash;
 }
 
-bool hash_pertenece(const hash_t *hash, const char *clave) {
-    size_t pos = hash_f( (char*) clave) % hash->capacidad;
+hash_t *hash_crear_motor(hash_destruir_dato_t destruir_dato, hash_motor_t motor){
+    hash_opciones_t opciones = { .motor = motor };
+    return hash_crear_opciones(destruir_dato, &opciones);
+}
 
-    while (hash->tabla[pos].estado != VACIO) {
-        if (hash->tabla[pos].estado != BORRADO && strcmp( (char*) hash->tabla[pos].clave, clave) == 0){
-            return true;  
-        } 
+hash_t *hash_crear(hash_destruir_dato_t destruir_dato){
+    return hash_crear_motor(destruir_dato, HASH_MOTOR_LINEAL);
+}
+
+// Compara primero hashes y largos para no tocar la memoria de la clave si difieren.
+static bool misma_clave(const hash_t *hash, const campo_t *campo, unsigned long h, const char *clave, size_t largo) {
+    if (claves_propias(hash)) return campo->hash == h && hash->tipo.iguales(ver_clave(hash, campo), clave);
+    return campo->hash == h && largo_clave(campo) == largo && memcmp(ver_clave(hash, campo), clave, largo) == 0;
+}
+
+/* Sondeo lineal. Mientras haya un grupo entero antes del final de la tabla
+ * compara sus 16 bytes de control de una vez; cerca del final, o sin SSE2,
+ * avanza de a una posición. Si la clave no está, deja en libre el primer
+ * lugar borrado o vacío del recorrido.
+ */
+static size_t buscar_lineal(const hash_t *hash, const char *clave, size_t largo, unsigned long h, size_t *libre,
+                            size_t *visitadas) {
+    size_t pos = h & (hash->capacidad - 1);
+    unsigned char buscada = etiqueta(h);
+
+    while (true) {
+#ifdef __SSE2__
+        if (pos + TAMANIO_GRUPO <= hash->capacidad) {
+            __m128i grupo = _mm_loadu_si128((const __m128i*) &hash->control[pos]);
+            unsigned coincidencias = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(grupo, _mm_set1_epi8((char) buscada)));
+            unsigned vacios = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(grupo, _mm_set1_epi8((char) VACIO)));
+            unsigned borrados = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(grupo, _mm_set1_epi8((char) BORRADO)));
+            // Solo cuentan las posiciones anteriores al primer vacío.
+            unsigned limite = vacios ? (unsigned) __builtin_ctz(vacios) : TAMANIO_GRUPO;
+            coincidencias &= (1u << limite) - 1;
+            borrados &= (1u << limite) - 1;
+            if (*libre == hash->capacidad && borrados) *libre = pos + (unsigned) __builtin_ctz(borrados);
+
+            while (coincidencias) {
+                unsigned i = (unsigned) __builtin_ctz(coincidencias);
+                if (misma_clave(hash, &hash->tabla[pos + i], h, clave, largo)) {
+                    *visitadas += i + 1;
+                    return pos + i;
+                }
+                coincidencias &= coincidencias - 1;
+            }
+            if (vacios) {
+                *visitadas += limite + 1;
+                if (*libre == hash->capacidad) *libre = pos + limite;
+                return hash->capacidad;
+            }
+            *visitadas += TAMANIO_GRUPO;
+            pos += TAMANIO_GRUPO;
+            if (pos == hash->capacidad) pos = 0;
+            continue;
+        }
+#endif
+        (*visitadas)++;
+        if (hash->control[pos] == VACIO) {
+            if (*libre == hash->capacidad) *libre = pos;
+            return hash->capacidad;
+        }
+        if (hash->control[pos] == BORRADO && *libre == hash->capacidad) *libre = pos;
+        if (hash->control[pos] == buscada && misma_clave(hash, &hash->tabla[pos], h, clave, largo)) return pos;
         pos++;
         if (pos == hash->capacidad) pos = 0;
     }
-    return false;
 }
 
-void *hash_obtener(const hash_t *hash, const char *clave) {
-    size_t pos = hash_f((char*) clave) % hash->capacidad;
+/* Sondeo Robin Hood. Si la clave no está, deja en libre la posición donde
+ * le corresponde ir: un lugar vacío o uno cuyo ocupante hay que desplazar.
+ */
+static size_t buscar_robin_hood(const hash_t *hash, const char *clave, size_t largo, unsigned long h,
+                                size_t *libre, size_t *visitadas) {
+    size_t pos = h & (hash->capacidad - 1);
+    unsigned char buscada = etiqueta(h);
 
-    while (hash->tabla[pos].estado != VACIO) {
-        if (hash->tabla[pos].estado != BORRADO && strcmp( (char*) hash->tabla[pos].clave, clave) == 0) {
-            return hash->tabla[pos].valor;
+    for (size_t distancia = 0; hash->control[pos] != VACIO; distancia++) {
+        (*visitadas)++;
+        // Si la clave estuviera ya habría desplazado a este campo.
+        if (distancia_a_origen(hash->tabla[pos].hash, pos, hash->capacidad) < distancia) {
+            *libre = pos;
+            return hash->capacidad;
         }
+        if (hash->control[pos] == buscada && misma_clave(hash, &hash->tabla[pos], h, clave, largo)) return pos;
         pos++;
         if (pos == hash->capacidad) pos = 0;
     }
+    (*visitadas)++;
+    *libre = pos;
+    return hash->capacidad;
+}
 
-    return NULL;
+/* Devuelve la posición de la clave de 'largo' bytes, cuyo hash es h, en la
+ * tabla, o la capacidad si no está. En ese caso, si libre no es NULL, guarda
+ * ahí dónde habría que insertarla. Si sondeos no es NULL, guarda ahí la
+ * cantidad de posiciones visitadas.
+ */
+static size_t buscar_posicion(const hash_t *hash, const char *clave, size_t largo, unsigned long h,
+                              size_t *libre, size_t *sondeos) {
+    size_t visitadas = 0;
+    size_t lugar = hash->capacidad;
+    size_t resultado;
+
+    if (hash->motor == HASH_MOTOR_ROBIN_HOOD) {
+        resultado = buscar_robin_hood(hash, clave, largo, h, &lugar, &visitadas);
+    } else {
+        resultado = buscar_lineal(hash, clave, largo, h, &lugar, &visitadas);
+    }
+    if (libre) *libre = lugar;
+    if (sondeos) *sondeos = visitadas;
+    return resultado;
 }
 
+/* Ubica a partir de pos, a la distancia indicada de su posición original, un
+ * campo cuya clave no está en la tabla. En sondeo lineal ocupa el primer
+ * lugar libre o borrado; en Robin Hood le cede el lugar a quien esté más
+ * lejos de su posición original. Devuelve el byte de control que tenía el
+ * lugar ocupado por el último campo movido.
+ */
+static unsigned char colocar_desde(hash_motor_t motor, campo_t *tabla, unsigned char *control, size_t capacidad,
+                                   campo_t campo, size_t pos, size_t distancia) {
+    unsigned char actual = etiqueta(campo.hash);
 
-bool redimensionar(hash_t *hash, size_t nueva_capacidad){
+    while (ocupado(control[pos])) {
+        if (motor == HASH_MOTOR_ROBIN_HOOD) {
+            size_t distancia_ocupante = distancia_a_origen(tabla[pos].hash, pos, capacidad);
+            if (distancia_ocupante < distancia) {
+                campo_t desplazado = tabla[pos];
+                unsigned char etiqueta_desplazada = control[pos];
+                tabla[pos] = campo;
+                control[pos] = actual;
+                campo = desplazado;
+                actual = etiqueta_desplazada;
+                distancia = distancia_ocupante;
+            }
+        }
+        pos++;
+        distancia++;
+        if (pos == capacidad) pos = 0;
+    }
 
-    campo_t* nueva_tabla = malloc(nueva_capacidad * sizeof(campo_t));
-    if(!nueva_tabla) return false;
+    unsigned char anterior = control[pos];
+    tabla[pos] = campo;
+    control[pos] = actual;
+    return anterior;
+}
 
-    crear_campo(nueva_tabla,nueva_capacidad);
+static unsigned char colocar(hash_motor_t motor, campo_t *tabla, unsigned char *control, size_t capacidad,
+                             campo_t campo) {
+    return colocar_desde(motor, tabla, control, capacidad, campo, campo.hash & (capacidad - 1), 0);
+}
 
-    for(int i = 0; i < hash->capacidad; i++){
-        if(hash->tabla[i].estado == OCUPADO){
-            size_t pos = hash_f((char*) hash->tabla[i].clave) % nueva_capacidad;
-            char* copia_clave = strdup(hash->tabla[i].clave);
+/* Busca la clave en la tabla que se está migrando. Los campos ya migrados
+ * quedan como borrados, así que alcanza con avanzar hasta el primer vacío,
+ * también con Robin Hood. Devuelve capacidad_vieja si no está.
+ */
+static size_t buscar_en_vieja(const hash_t *hash, const char *clave, size_t largo, unsigned long h,
+                              size_t *visitadas) {
+    size_t pos = h & (hash->capacidad_vieja - 1);
+    unsigned char buscada = etiqueta(h);
 
-            while (nueva_tabla[pos].estado == OCUPADO){
-                pos++;
-                if (pos == nueva_capacidad) pos = 0;
-            }
+    while (hash->control_viejo[pos] != VACIO) {
+        (*visitadas)++;
+        if (hash->control_viejo[pos] == buscada && misma_clave(hash, &hash->vieja[pos], h, clave, largo)) return pos;
+        pos++;
+        if (pos == hash->capacidad_vieja) pos = 0;
+    }
+    (*visitadas)++;
+    return hash->capacidad_vieja;
+}
+
+/* Devuelve el campo de la clave, en la tabla actual o en la que se está
+ * migrando, o NULL si no está. Si sondeos no es NULL, guarda ahí la cantidad
+ * de posiciones visitadas en las dos tablas.
+ */
+static campo_t *buscar_campo(const hash_t *hash, const char *clave, size_t largo, unsigned long h,
+                             size_t *sondeos) {
+    size_t visitadas;
+    size_t pos = buscar_posicion(hash, clave, largo, h, NULL, &visitadas);
+    campo_t *campo = pos == hash->capacidad ? NULL : &hash->tabla[pos];
 
-            nueva_tabla[pos].clave = copia_clave;
-            nueva_tabla[pos].valor = hash->tabla[i].valor;
-            nueva_tabla[pos].estado = OCUPADO;
+    if (!campo && hash->vieja) {
+        pos = buscar_en_vieja(hash, clave, largo, h, &visitadas);
+        if (pos != hash->capacidad_vieja) campo = &hash->vieja[pos];
+    }
+    if (sondeos) *sondeos = visitadas;
+
+    if (campo) SUMAR(hash, aciertos, 1);
+    else SUMAR(hash, fallos, 1);
+    SUMAR(hash, sondeos[bucket_estadisticas(visitadas)], 1);
+    return campo;
+}
+
+// Las claves propias no tienen largo: se comparan con la función iguales.
+static size_t largo_de(const hash_t *hash, const char *clave) {
+    return claves_propias(hash) ? 0 : strlen(clave);
+}
+
+bool hash_pertenece_bytes(const hash_t *hash, const void *clave, size_t largo) {
+    return buscar_campo(hash, clave, largo, calcular_hash(hash, clave, largo), NULL) != NULL;
+}
+
+bool hash_pertenece(const hash_t *hash, const char *clave) {
+    return hash_pertenece_bytes(hash, clave, largo_de(hash, clave));
+}
+
+void *hash_obtener_bytes(const hash_t *hash, const void *clave, size_t largo) {
+    campo_t *campo = buscar_campo(hash, clave, largo, calcular_hash(hash, clave, largo), NULL);
+    return campo ? ver_valor(hash, campo) : NULL;
+}
+
+void *hash_obtener(const hash_t *hash, const char *clave) {
+    return hash_obtener_bytes(hash, clave, largo_de(hash, clave));
+}
+
+bool hash_pertenece_clave(const hash_t *hash, const void *clave) {
+    return hash_pertenece_bytes(hash, clave, largo_de(hash, clave));
+}
+
+void *hash_obtener_clave(const hash_t *hash, const void *clave) {
+    return hash_obtener_bytes(hash, clave, largo_de(hash, clave));
+}
 
-            free(hash->tabla[i].clave);
+/* Hashea las claves de a TAMANIO_LOTE y pide a la caché el byte de control y
+ * el campo de cada posición original antes de buscarlas, así las esperas a
+ * memoria de todo el lote se superponen en lugar de sumarse.
+ */
+void hash_obtener_lote(const hash_t *hash, const char *const *claves, size_t cantidad, void **datos) {
+    size_t largos[TAMANIO_LOTE];
+    unsigned long hashes[TAMANIO_LOTE];
+
+    for (size_t inicio = 0; inicio < cantidad; inicio += TAMANIO_LOTE) {
+        size_t fin = cantidad - inicio < TAMANIO_LOTE ? cantidad : inicio + TAMANIO_LOTE;
+
+        for (size_t i = inicio; i < fin; i++) {
+            largos[i - inicio] = largo_de(hash, claves[i]);
+            hashes[i - inicio] = calcular_hash(hash, claves[i], largos[i - inicio]);
+            size_t pos = hashes[i - inicio] & (hash->capacidad - 1);
+            __builtin_prefetch(&hash->control[pos]);
+            __builtin_prefetch(&hash->tabla[pos]);
+        }
+
+        for (size_t i = inicio; i < fin; i++) {
+            campo_t *campo = buscar_campo(hash, claves[i], largos[i - inicio], hashes[i - inicio], NULL);
+            datos[i] = campo ? ver_valor(hash, campo) : NULL;
+        }
+    }
+}
+
+
+/* Mueve a la tabla actual los campos de hasta 'posiciones' posiciones de la
+ * tabla vieja, dejándolas borradas para no cortar las cadenas de sondeo de
+ * las que siguen. Al terminar con la tabla vieja la libera.
+ */
+static void migrar(hash_t *hash, size_t posiciones) {
+    EMPEZAR_MEDICION(inicio);
+    while (posiciones > 0 && hash->migrados < hash->capacidad_vieja) {
+        size_t i = hash->migrados++;
+        posiciones--;
+        if (!ocupado(hash->control_viejo[i])) continue;
+        // Los borrados de la tabla actual pueden ser de claves borradas durante la migración.
+        if (colocar(hash->motor, hash->tabla, hash->control, hash->capacidad, hash->vieja[i]) == BORRADO) {
+            hash->borrados--;
+        }
+        hash->control_viejo[i] = BORRADO;
+        SUMAR(hash, bytes_movidos, sizeof(campo_t));
+    }
+    TERMINAR_MEDICION(hash, inicio);
+    if (hash->migrados == hash->capacidad_vieja) {
+        free(hash->vieja);
+        free(hash->control_viejo);
+        hash->vieja = NULL;
+        hash->control_viejo = NULL;
+        hash->capacidad_vieja = 0;
+    }
+}
+
+/* Redimensión incremental: la tabla actual pasa a ser la vieja y se crea una
+ * nueva vacía. Cada operación que modifica el hash migra unas pocas
+ * posiciones, así ninguna paga sola por mover la tabla entera.
+ */
+static bool empezar_migracion(hash_t *hash, size_t nueva_capacidad) {
+    if (hash->vieja) migrar(hash, hash->capacidad_vieja);
+
+    campo_t* nueva_tabla;
+    unsigned char* nuevo_control;
+    if(!crear_tabla(nueva_capacidad, &nueva_tabla, &nuevo_control)) return false;
+
+    hash->vieja = hash->tabla;
+    hash->control_viejo = hash->control;
+    hash->capacidad_vieja = hash->capacidad;
+    hash->migrados = 0;
+    hash->tabla = nueva_tabla;
+    hash->control = nuevo_control;
+    hash->capacidad = nueva_capacidad;
+    hash->borrados = 0;
+    actualizar_umbrales(hash);
+    SUMAR(hash, redimensiones, 1);
+    return true;
+}
+
+bool redimensionar(hash_t *hash, size_t nueva_capacidad){
+
+    if (hash->mapa) return false;
+    if (hash->vieja) migrar(hash, hash->capacidad_vieja);
+
+    EMPEZAR_MEDICION(inicio);
+    campo_t* nueva_tabla;
+    unsigned char* nuevo_control;
+    if(!crear_tabla(nueva_capacidad, &nueva_tabla, &nuevo_control)) return false;
+
+    // Las claves pasan a la nueva tabla por puntero, sin copiarlas.
+    for(size_t i = 0; i < hash->capacidad; i++){
+        if(ocupado(hash->control[i])){
+            colocar(hash->motor, nueva_tabla, nuevo_control, nueva_capacidad, hash->tabla[i]);
         }
     }
     free(hash->tabla);
+    free(hash->control);
     hash->tabla = nueva_tabla;
+    hash->control = nuevo_control;
     hash->capacidad = nueva_capacidad;
+    hash->borrados = 0;
+    actualizar_umbrales(hash);
 
+    SUMAR(hash, redimensiones, 1);
+    SUMAR(hash, bytes_movidos, hash->cantidad * sizeof(campo_t));
+    TERMINAR_MEDICION(hash, inicio);
     return true;
 }
 
+// La menor capacidad en la que entran 'cantidad' claves sin pasar la carga
+// máxima, o 0 si no entran en ninguna.
+static size_t capacidad_para(const hash_t *hash, size_t cantidad) {
+    size_t capacidad = hash->capacidad_minima;
+    while (cantidad >= capacidad || (double) cantidad > (double) capacidad * hash->carga_maxima) {
+        if (capacidad >= CAPACIDAD_MAXIMA) return 0;
+        capacidad *= 2;
+    }
+    return capacidad;
+}
 
-bool hash_guardar(hash_t *hash, const char *clave, void *dato){
+// Agranda la tabla a 'capacidad' si es mayor que la actual. 0 indica que no hay capacidad suficiente.
+static bool agrandar_para(hash_t *hash, size_t capacidad) {
+    if (capacidad == 0) return false;
+    return capacidad <= hash->capacidad || redimensionar(hash, capacidad);
+}
+
+bool hash_reservar(hash_t *hash, size_t cantidad) {
+    size_t capacidad = capacidad_para(hash, cantidad);
+    if (!agrandar_para(hash, capacidad)) return false;
+    if (capacidad > hash->capacidad_reservada) hash->capacidad_reservada = capacidad;
+    return true;
+}
 
-    if((float)hash->cantidad / (float)hash->capacidad >= VALOR_CARGA){
-        if(!redimensionar(hash, hash->capacidad*2)) return false;
+bool hash_compactar(hash_t *hash) {
+    if (!redimensionar(hash, capacidad_para(hash, hash->cantidad))) return false;
+    hash->capacidad_reservada = 0;
+    return true;
+}
+
+/* Busca la clave y, si no está, la guarda con el dato en el lugar que dejó
+ * la misma búsqueda, así la clave se hashea y se sondea una sola vez.
+ * Devuelve el campo de la clave, o NULL si no se pudo guardar.
+ */
+static campo_t *buscar_o_insertar(hash_t *hash, const char *clave, size_t largo, void *dato, bool *existia) {
+
+    if (hash->mapa) return NULL;
+    if (hash->vieja) migrar(hash, MIGRAR_POR_OPERACION);
+
+    // Los borrados también alargan los sondeos, así que cuentan para la carga.
+    // Si son la mayoría alcanza con rehashear sin agrandar la tabla.
+    if(hash->cantidad + hash->borrados >= hash->umbral_crecer){
+        size_t nueva_capacidad = hash->borrados >= hash->cantidad ? hash->capacidad : hash->capacidad * hash->factor_crecimiento;
+        bool ok = hash->incremental ? empezar_migracion(hash, nueva_capacidad) : redimensionar(hash, nueva_capacidad);
+        if(!ok) return NULL;
     }
-    
-    size_t pos = hash_f((char*) clave) % hash->capacidad;
 
-    if (hash_pertenece(hash, clave)) {
-        while (strcmp( (char*) hash->tabla[pos].clave, clave) != 0) {
-            pos++;
-            if (pos == hash->capacidad) pos = 0;
-        }
+    unsigned long h = calcular_hash(hash, clave, largo);
+    size_t libre;
+    size_t pos = buscar_posicion(hash, clave, largo, h, &libre, NULL);
 
-        if (hash->funcion_destruccion) hash->funcion_destruccion(hash->tabla[pos].valor);
-        hash->tabla[pos].valor = dato;
-        return true;
+    *existia = pos != hash->capacidad;
+    if (*existia) return &hash->tabla[pos];
 
+    // Las claves nuevas van siempre a la tabla actual, pero antes hay que
+    // ver que no esté en la vieja.
+    if (hash->vieja) {
+        size_t visitadas = 0;
+        pos = buscar_en_vieja(hash, clave, largo, h, &visitadas);
+        *existia = pos != hash->capacidad_vieja;
+        if (*existia) return &hash->vieja[pos];
     }
 
-    char* copia_clave = strdup(clave);
+    campo_t campo;
+    if (!guardar_clave(hash, &campo, clave, largo)) return NULL;
+    campo.valor = dato;
+    campo.hash = h;
 
-    while (hash->tabla[pos].estado == OCUPADO){
-        pos++;
-        if (pos == hash->capacidad) pos = 0;
+    // En los dos motores la clave nueva queda en libre; Robin Hood puede
+    // además correr a los campos siguientes.
+    size_t distancia = distancia_a_origen(h, libre, hash->capacidad);
+    if (colocar_desde(hash->motor, hash->tabla, hash->control, hash->capacidad, campo, libre, distancia) == BORRADO) {
+        hash->borrados--;
     }
-    
-    hash->tabla[pos].clave = copia_clave;
-    hash->tabla[pos].valor = dato;
-    hash->tabla[pos].estado = OCUPADO;
     hash->cantidad++;
 
+    return &hash->tabla[libre];
+}
+
+bool hash_guardar_bytes(hash_t *hash, const void *clave, size_t largo, void *dato){
+    bool existia;
+    campo_t *campo = buscar_o_insertar(hash, clave, largo, dato, &existia);
+    if (!campo) return false;
+
+    if (existia) {
+        if (hash->funcion_destruccion) hash->funcion_destruccion(campo->valor);
+        campo->valor = dato;
+    }
     return true;
 }
 
+bool hash_guardar(hash_t *hash, const char *clave, void *dato){
+    return hash_guardar_bytes(hash, clave, largo_de(hash, clave), dato);
+}
+
+bool hash_guardar_clave(hash_t *hash, const void *clave, void *dato){
+    return hash_guardar_bytes(hash, clave, largo_de(hash, clave), dato);
+}
+
+void **hash_obtener_o_guardar(hash_t *hash, const char *clave, void *dato, bool *guardado) {
+    bool existia;
+    campo_t *campo = buscar_o_insertar(hash, clave, largo_de(hash, clave), dato, &existia);
+    if (!campo) return NULL;
+
+    if (guardado) *guardado = !existia;
+    return &campo->valor;
+}
+
 size_t hash_cantidad(const hash_t *hash) {
     return hash->cantidad;
 }
 
+unsigned long hash_calcular(const hash_t *hash, const void *clave, size_t largo) {
+    return calcular_hash(hash, clave, largo);
+}
+
+unsigned long hash_wyhash(const void *clave, size_t largo) {
+    return (unsigned long) hash_wy(clave, largo);
+}
+
+size_t hash_largo_sondeo(const hash_t *hash, const char *clave) {
+    size_t sondeos;
+    size_t largo = largo_de(hash, clave);
+    buscar_campo(hash, clave, largo, calcular_hash(hash, clave, largo), &sondeos);
+    return sondeos;
+}
+
+/* Robin Hood no deja borrados: corre una posición hacia atrás a los campos
+ * siguientes hasta encontrar uno vacío o uno que ya está en su lugar.
+ */
+static void desplazar_hacia_atras(hash_t *hash, size_t pos) {
+    size_t siguiente = pos + 1;
+    if (siguiente == hash->capacidad) siguiente = 0;
+
+    while (ocupado(hash->control[siguiente]) &&
+           distancia_a_origen(hash->tabla[siguiente].hash, siguiente, hash->capacidad) > 0) {
+        hash->tabla[pos] = hash->tabla[siguiente];
+        hash->control[pos] = hash->control[siguiente];
+        pos = siguiente;
+        siguiente++;
+        if (siguiente == hash->capacidad) siguiente = 0;
+    }
+
+    hash->tabla[pos].valor = NULL;
+    hash->control[pos] = VACIO;
+}
+
+// Borra la clave de la tabla que se está migrando, dejando la marca de borrado.
+static void *borrar_de_vieja(hash_t *hash, const char *clave, size_t largo, unsigned long h) {
+    size_t visitadas = 0;
+    size_t pos = buscar_en_vieja(hash, clave, largo, h, &visitadas);
+    if (pos == hash->capacidad_vieja) return NULL;
+
+    campo_t *campo = &hash->vieja[pos];
+    soltar_clave(hash, campo);
+    hash->control_viejo[pos] = BORRADO;
+    hash->cantidad--;
+    return campo->valor;
+}
+
+// Borra el campo de la posición pos de la tabla actual y devuelve su dato.
+static void *quitar(hash_t *hash, size_t pos) {
+    campo_t *campo = &hash->tabla[pos];
+    void *valor = campo->valor;
+    soltar_clave(hash, campo);
+    hash->cantidad--;
+
+    if (hash->motor == HASH_MOTOR_ROBIN_HOOD) {
+        desplazar_hacia_atras(hash, pos);
+        return valor;
+    }
+
+    hash->control[pos] = BORRADO;
+    hash->borrados++;
+    return valor;
+}
+
+/* Achica la tabla a la mitad si quedó poco cargada. Si no hay memoria para
+ * la nueva tabla sigue usando la actual.
+ */
+static void achicar(hash_t *hash) {
+    if (hash->vieja || hash->capacidad <= hash->capacidad_minima || hash->capacidad <= hash->capacidad_reservada) return;
+    if (hash->cantidad >= hash->umbral_achicar) return;
+
+    if (hash->incremental) empezar_migracion(hash, hash->capacidad / 2);
+    else redimensionar(hash, hash->capacidad / 2);
+}
+
+void *hash_borrar_bytes(hash_t *hash, const void *clave, size_t largo) {
+
+    if (hash->mapa) return NULL;
+    if (hash->vieja) migrar(hash, MIGRAR_POR_OPERACION);
+
+    unsigned long h = calcular_hash(hash, clave, largo);
+    size_t pos = buscar_posicion(hash, clave, largo, h, NULL, NULL);
+    if (pos == hash->capacidad) return hash->vieja ? borrar_de_vieja(hash, clave, largo, h) : NULL;
+
+    void *valor = quitar(hash, pos);
+    achicar(hash);
+    return valor;
+}
+
 void *hash_borrar(hash_t *hash, const char *clave) {
+    return hash_borrar_bytes(hash, clave, largo_de(hash, clave));
+}
 
-    size_t pos = hash_f( (char*) clave) % hash->capacidad;
+void *hash_borrar_clave(hash_t *hash, const void *clave) {
+    return hash_borrar_bytes(hash, clave, largo_de(hash, clave));
+}
 
-    while (hash->tabla[pos].estado != VACIO) {
+/* ******************************************************************
+ *                        CARGA EN PARALELO
+ * *****************************************************************/
+
+/* hash_cargar reparte la tabla en regiones contiguas de al menos este tamaño
+ * y cada hilo ubica las claves cuya posición original cae en sus regiones.
+ */
+#define REGION_MINIMA 1024
+
+typedef struct carga{
+  hash_t* hash;
+  const char* const* claves;
+  void* const* datos;
+  size_t cantidad;
+  size_t hilos;
+  unsigned long* hashes;
+  size_t* orden; // Índices de las claves, agrupados por región.
+  size_t* inicio_region; // regiones + 1 elementos: dónde empieza cada una en orden.
+  size_t regiones;
+  unsigned desplazamiento; // Posición >> desplazamiento = región.
+  char* copias; // Con arena, lugar para las claves largas de todas las regiones.
+  size_t* inicio_copias; // Dónde empiezan en copias las claves de cada región.
+  bool fallo;
+} carga_t;
+
+typedef struct hilo_carga{
+  carga_t* carga;
+  size_t numero;
+  campo_t* pendientes; // Campos que no entraron en su región.
+  size_t cantidad_pendientes;
+  size_t capacidad_pendientes;
+} hilo_carga_t;
+
+static size_t region(const carga_t *carga, unsigned long h) {
+    return (h & (carga->hash->capacidad - 1)) >> carga->desplazamiento;
+}
 
-        if (hash->tabla[pos].estado != BORRADO && strcmp( (char*) hash->tabla[pos].clave, clave) == 0) {
-            free(hash->tabla[pos].clave);
-            hash->tabla[pos].clave = NULL;
-            hash->tabla[pos].estado = BORRADO;
-            hash->cantidad--;
-            return hash->tabla[pos].valor;
+// Lugar que ocupa en la arena la copia de una clave larga.
+static size_t lugar_en_arena(size_t largo) {
+    return (largo + 1 + 7) & ~(size_t) 7;
+}
+
+static void *hashear_claves(void *extra) {
+    hilo_carga_t *hilo = extra;
+    carga_t *carga = hilo->carga;
+    size_t inicio = carga->cantidad * hilo->numero / carga->hilos;
+    size_t fin = carga->cantidad * (hilo->numero + 1) / carga->hilos;
+
+    for (size_t i = inicio; i < fin; i++) {
+        carga->hashes[i] = calcular_hash(carga->hash, carga->claves[i], strlen(carga->claves[i]));
+    }
+    return NULL;
+}
+
+/* Como colocar, pero sin pasar de la posición fin. Si el campo, o uno que
+ * haya desplazado Robin Hood, tendría que ir más allá, lo deja en campo y
+ * devuelve false.
+ */
+static bool colocar_hasta(hash_motor_t motor, campo_t *tabla, unsigned char *control, size_t capacidad,
+                          campo_t *campo, size_t fin) {
+    size_t pos = campo->hash & (capacidad - 1);
+    size_t distancia = 0;
+    unsigned char actual = etiqueta(campo->hash);
+
+    for (; pos < fin && ocupado(control[pos]); pos++, distancia++) {
+        if (motor != HASH_MOTOR_ROBIN_HOOD) continue;
+        size_t distancia_ocupante = distancia_a_origen(tabla[pos].hash, pos, capacidad);
+        if (distancia_ocupante < distancia) {
+            campo_t desplazado = tabla[pos];
+            unsigned char etiqueta_desplazada = control[pos];
+            tabla[pos] = *campo;
+            control[pos] = actual;
+            *campo = desplazado;
+            actual = etiqueta_desplazada;
+            distancia = distancia_ocupante;
         }
+    }
+    if (pos == fin) return false;
+    tabla[pos] = *campo;
+    control[pos] = actual;
+    return true;
+}
 
-        pos++;        
-        if (pos == hash->capacidad) pos = 0;
+static bool agregar_pendiente(hilo_carga_t *hilo, campo_t campo) {
+    if (hilo->cantidad_pendientes == hilo->capacidad_pendientes) {
+        size_t capacidad = hilo->capacidad_pendientes ? hilo->capacidad_pendientes * 2 : 64;
+        campo_t *pendientes = realloc(hilo->pendientes, capacidad * sizeof(campo_t));
+        if (!pendientes) return false;
+        hilo->pendientes = pendientes;
+        hilo->capacidad_pendientes = capacidad;
     }
+    hilo->pendientes[hilo->cantidad_pendientes++] = campo;
+    return true;
+}
+
+static void liberar_campo(hash_t *hash, campo_t *campo) {
+    if (!hash->arena && !clave_corta(campo)) free(campo->clave.larga.puntero);
+}
+
+/* Ubica las claves de las regiones del hilo. Con arena, las copias de las
+ * claves largas van al lugar ya reservado para la región, porque la arena
+ * no se puede usar desde varios hilos.
+ */
+static void *ubicar_claves(void *extra) {
+    hilo_carga_t *hilo = extra;
+    carga_t *carga = hilo->carga;
+    hash_t *hash = carga->hash;
+
+    for (size_t r = hilo->numero; r < carga->regiones; r += carga->hilos) {
+        size_t fin = (r + 1) << carga->desplazamiento;
+        char *copia = carga->copias ? carga->copias + carga->inicio_copias[r] : NULL;
+
+        for (size_t k = carga->inicio_region[r]; k < carga->inicio_region[r + 1]; k++) {
+            if (__atomic_load_n(&carga->fallo, __ATOMIC_RELAXED)) return NULL;
+            size_t i = carga->orden[k];
+            size_t largo = strlen(carga->claves[i]);
+            campo_t campo;
 
+            if (copia && largo > LARGO_CLAVE_CORTA && largo <= UINT32_MAX) {
+                memcpy(copia, carga->claves[i], largo + 1);
+                campo.clave.larga.puntero = copia;
+                campo.clave.larga.largo = (uint32_t) largo;
+                campo.clave.corta[LARGO_CLAVE_CORTA] = (char) CLAVE_LARGA;
+                copia += lugar_en_arena(largo);
+            } else if (!guardar_clave(hash, &campo, carga->claves[i], largo)) {
+                __atomic_store_n(&carga->fallo, true, __ATOMIC_RELAXED);
+                return NULL;
+            }
+            campo.valor = carga->datos[i];
+            campo.hash = carga->hashes[i];
+
+            if (colocar_hasta(hash->motor, hash->tabla, hash->control, hash->capacidad, &campo, fin)) continue;
+            if (!agregar_pendiente(hilo, campo)) {
+                liberar_campo(hash, &campo);
+                __atomic_store_n(&carga->fallo, true, __ATOMIC_RELAXED);
+                return NULL;
+            }
+        }
+    }
     return NULL;
 }
 
-void hash_destruir(hash_t *hash) {
+// Si no se puede crear algún hilo, su parte la hace el que llama.
+static void ejecutar_en_hilos(hilo_carga_t *hilos, size_t cantidad, void *(*trabajo)(void *)) {
+    pthread_t *ids = malloc(cantidad * sizeof(pthread_t));
+    bool *creado = calloc(cantidad, sizeof(bool));
+
+    for (size_t i = 1; i < cantidad && ids && creado; i++) {
+        creado[i] = pthread_create(&ids[i], NULL, trabajo, &hilos[i]) == 0;
+    }
+    trabajo(&hilos[0]);
+    for (size_t i = 1; i < cantidad; i++) {
+        if (ids && creado && creado[i]) pthread_join(ids[i], NULL);
+        else trabajo(&hilos[i]);
+    }
+    free(ids);
+    free(creado);
+}
+
+/* Agrupa los índices de las claves por región, sin cambiar su orden dentro
+ * de cada una, y con arena reserva de una vez el lugar para las claves largas.
+ */
+static bool agrupar_por_region(carga_t *carga) {
+    size_t *siguiente = calloc(carga->regiones, sizeof(size_t));
+    if (!siguiente) return false;
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < carga->cantidad; i++) {
+        size_t r = region(carga, carga->hashes[i]);
+        carga->inicio_region[r + 1]++;
+        if (carga->inicio_copias) {
+            size_t largo = strlen(carga->claves[i]);
+            if (largo > LARGO_CLAVE_CORTA) carga->inicio_copias[r + 1] += lugar_en_arena(largo);
+        }
+    }
+    for (size_t r = 0; r < carga->regiones; r++) {
+        carga->inicio_region[r + 1] += carga->inicio_region[r];
+        siguiente[r] = carga->inicio_region[r];
+        if (carga->inicio_copias) carga->inicio_copias[r + 1] += carga->inicio_copias[r];
+    }
+    for (size_t i = 0; i < carga->cantidad; i++) {
+        carga->orden[siguiente[region(carga, carga->hashes[i])]++] = i;
+    }
+    free(siguiente);
+
+    if (carga->inicio_copias) bytes = carga->inicio_copias[carga->regiones];
+    if (bytes > 0) carga->copias = arena_pedir(carga->hash->arena, bytes);
+    return bytes == 0 || carga->copias;
+}
+
+// Deja la tabla vacía después de una carga fallida.
+static void deshacer_carga(hash_t *hash, hilo_carga_t *hilos, size_t cantidad_hilos) {
+    for (size_t i = 0; i < hash->capacidad; i++) {
+        if (ocupado(hash->control[i])) liberar_campo(hash, &hash->tabla[i]);
+    }
+    for (size_t h = 0; h < cantidad_hilos; h++) {
+        for (size_t i = 0; i < hilos[h].cantidad_pendientes; i++) liberar_campo(hash, &hilos[h].pendientes[i]);
+    }
+    crear_campo(hash->tabla, hash->control, hash->capacidad);
+}
+
+static bool cargar_en_paralelo(carga_t *carga, hilo_carga_t *hilos) {
+    hash_t *hash = carga->hash;
+
+    ejecutar_en_hilos(hilos, carga->hilos, hashear_claves);
+    if (!agrupar_por_region(carga)) return false;
+    ejecutar_en_hilos(hilos, carga->hilos, ubicar_claves);
+
+    if (carga->fallo) {
+        deshacer_carga(hash, hilos, carga->hilos);
+        return false;
+    }
+    // Los que no entraron en su región se ubican al final, sin límite.
+    for (size_t h = 0; h < carga->hilos; h++) {
+        for (size_t i = 0; i < hilos[h].cantidad_pendientes; i++) {
+            colocar(hash->motor, hash->tabla, hash->control, hash->capacidad, hilos[h].pendientes[i]);
+        }
+    }
+    hash->cantidad = carga->cantidad;
+    return true;
+}
+
+bool hash_cargar(hash_t *hash, const char *const *claves, void *const *datos, size_t cantidad, size_t hilos) {
+    if (hash->mapa) return false;
+
+    // Con elementos ya guardados no se puede ubicar todo de nuevo. Las
+    // funciones de las claves propias no tienen por qué poder usarse desde
+    // varios hilos.
+    if (hash->cantidad > 0 || hash->vieja || claves_propias(hash)) {
+        bool ok = agrandar_para(hash, capacidad_para(hash, hash->cantidad + cantidad));
+        for (size_t i = 0; i < cantidad && ok; i++) ok = hash_guardar_clave(hash, claves[i], datos[i]);
+        return ok;
+    }
+
+    size_t capacidad = capacidad_para(hash, cantidad);
+    if (capacidad == 0) return false;
+    if (capacidad < hash->capacidad) capacidad = hash->capacidad;
+    if ((capacidad != hash->capacidad || hash->borrados > 0) && !redimensionar(hash, capacidad)) return false;
+    if (cantidad == 0) return true;
+
+    if (hilos == 0) {
+        long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+        hilos = procesadores > 0 ? (size_t) procesadores : 1;
+    }
+    if (hilos > cantidad) hilos = cantidad;
+
+    carga_t carga = {
+        .hash = hash, .claves = claves, .datos = datos, .cantidad = cantidad, .hilos = hilos, .regiones = 1
+    };
+    while (carga.regiones < hilos * 4 && capacidad / (carga.regiones * 2) >= REGION_MINIMA) carga.regiones *= 2;
+    while (((size_t) 1 << carga.desplazamiento) < capacidad / carga.regiones) carga.desplazamiento++;
+
+    hilo_carga_t *datos_hilos = calloc(hilos, sizeof(hilo_carga_t));
+    carga.hashes = malloc(cantidad * sizeof(unsigned long));
+    carga.orden = malloc(cantidad * sizeof(size_t));
+    carga.inicio_region = calloc(carga.regiones + 1, sizeof(size_t));
+    if (hash->arena) carga.inicio_copias = calloc(carga.regiones + 1, sizeof(size_t));
+
+    bool ok = datos_hilos && carga.hashes && carga.orden && carga.inicio_region &&
+              (!hash->arena || carga.inicio_copias);
+    if (ok) {
+        for (size_t i = 0; i < hilos; i++) datos_hilos[i] = (hilo_carga_t) { .carga = &carga, .numero = i };
+        ok = cargar_en_paralelo(&carga, datos_hilos);
+        for (size_t i = 0; i < hilos; i++) free(datos_hilos[i].pendientes);
+    }
+    free(datos_hilos);
+    free(carga.hashes);
+    free(carga.orden);
+    free(carga.inicio_region);
+    free(carga.inicio_copias);
+    return ok;
+}
+
+static void destruir_campos(hash_t *hash, campo_t *tabla, unsigned char *control, size_t capacidad) {
+    for (size_t i = siguiente_en(control, 0, capacidad); i < capacidad; i = siguiente_en(control, i + 1, capacidad)) {
+        if (hash->funcion_destruccion) hash->funcion_destruccion(tabla[i].valor);
+        if (!hash->arena) soltar_clave(hash, &tabla[i]);
+    }
+}
+
+/* El iterador recorre la tabla actual y después la que se está migrando:
+ * las posiciones desde la capacidad en adelante son de la tabla vieja.
+ */
+static size_t posiciones_iter(const hash_t *hash) {
+    return hash->capacidad + (hash->vieja ? hash->capacidad_vieja : 0);
+}
 
-    for (int i = 0; i < hash->capacidad; i++) {
-        if (hash->tabla[i].estado == OCUPADO) {
-            if (hash->funcion_destruccion) hash->funcion_destruccion(hash->tabla[i].valor);
-            free(hash->tabla[i].clave);
+static campo_t *campo_iter(const hash_t *hash, size_t pos) {
+    if (pos < hash->capacidad) return ocupado(hash->control[pos]) ? &hash->tabla[pos] : NULL;
+    pos -= hash->capacidad;
+    return ocupado(hash->control_viejo[pos]) ? &hash->vieja[pos] : NULL;
+}
+
+// Devuelve la primera posición ocupada desde pos, o posiciones_iter si no hay más.
+static size_t siguiente_ocupada(const hash_t *hash, size_t pos) {
+    if (pos < hash->capacidad) {
+        pos = siguiente_en(hash->control, pos, hash->capacidad);
+        if (pos < hash->capacidad || !hash->vieja) return pos;
+    }
+    if (!hash->vieja) return hash->capacidad;
+    return hash->capacidad + siguiente_en(hash->control_viejo, pos - hash->capacidad, hash->capacidad_vieja);
+}
+
+/* ******************************************************************
+ *                          ESTADÍSTICAS
+ * *****************************************************************/
+
+/* Agrega las distancias de los elementos de la tabla y, si se piden, los
+ * largos de las rachas de posiciones no vacías. Empieza después de un vacío
+ * para no partir en dos la racha que da la vuelta al final de la tabla.
+ */
+static void medir_tabla(const campo_t *tabla, const unsigned char *control, size_t capacidad,
+                        bool rachas, hash_estadisticas_t *estadisticas) {
+    size_t inicio = 0;
+    while (inicio < capacidad && control[inicio] != VACIO) inicio++;
+
+    size_t racha = 0;
+    for (size_t i = 1; i <= capacidad; i++) {
+        size_t pos = (inicio + i) & (capacidad - 1);
+        if (ocupado(control[pos])) {
+            size_t distancia = distancia_a_origen(tabla[pos].hash, pos, capacidad);
+            estadisticas->distancias[bucket_estadisticas(distancia)]++;
+            if (distancia > estadisticas->distancia_maxima) estadisticas->distancia_maxima = distancia;
         }
+        if (control[pos] != VACIO) {
+            racha++;
+            if (i < capacidad) continue;
+        }
+        if (rachas && racha > 0) {
+            estadisticas->rachas[bucket_estadisticas(racha)]++;
+            if (racha > estadisticas->racha_maxima) estadisticas->racha_maxima = racha;
+        }
+        racha = 0;
+    }
+}
+
+void hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas) {
+    memset(estadisticas, 0, sizeof(hash_estadisticas_t));
+    estadisticas->capacidad = hash->capacidad;
+    estadisticas->cantidad = hash->cantidad;
+    estadisticas->borrados = hash->borrados;
+    estadisticas->carga = (double) (hash->cantidad + hash->borrados) / (double) hash->capacidad;
+    estadisticas->proporcion_borrados = (double) hash->borrados / (double) hash->capacidad;
+
+    medir_tabla(hash->tabla, hash->control, hash->capacidad, true, estadisticas);
+    if (hash->vieja) medir_tabla(hash->vieja, hash->control_viejo, hash->capacidad_vieja, false, estadisticas);
+
+#ifdef HASH_ESTADISTICAS
+    const contadores_t *contadores = &hash->contadores;
+    estadisticas->contadores = true;
+    estadisticas->aciertos = __atomic_load_n(&contadores->aciertos, __ATOMIC_RELAXED);
+    estadisticas->fallos = __atomic_load_n(&contadores->fallos, __ATOMIC_RELAXED);
+    for (size_t i = 0; i < HASH_BUCKETS_ESTADISTICAS; i++) {
+        estadisticas->sondeos[i] = __atomic_load_n(&contadores->sondeos[i], __ATOMIC_RELAXED);
+    }
+    estadisticas->redimensiones = contadores->redimensiones;
+    estadisticas->bytes_movidos = contadores->bytes_movidos;
+    estadisticas->segundos_redimensionando = (double) contadores->ns_redimensionando / 1e9;
+#endif
+}
+
+static void imprimir_histograma(FILE *salida, const size_t histograma[HASH_BUCKETS_ESTADISTICAS]) {
+    size_t total = 0;
+    for (size_t i = 0; i < HASH_BUCKETS_ESTADISTICAS; i++) total += histograma[i];
+
+    for (size_t i = 0; i < HASH_BUCKETS_ESTADISTICAS; i++) {
+        if (histograma[i] == 0) continue;
+        size_t desde = i == 0 ? 0 : (size_t) 1 << (i - 1);
+        size_t hasta = i == 0 ? 0 : ((size_t) 1 << i) - 1;
+        char rango[48];
+        if (i == HASH_BUCKETS_ESTADISTICAS - 1) snprintf(rango, sizeof(rango), "%zu+", desde);
+        else if (desde == hasta) snprintf(rango, sizeof(rango), "%zu", desde);
+        else snprintf(rango, sizeof(rango), "%zu-%zu", desde, hasta);
+        fprintf(salida, "  %12s %12zu %6.2f%%\n", rango, histograma[i], 100.0 * (double) histograma[i] / (double) total);
+    }
+}
+
+void hash_estadisticas_imprimir(const hash_t *hash, FILE *salida) {
+    hash_estadisticas_t estadisticas;
+    hash_estadisticas(hash, &estadisticas);
+
+    fprintf(salida, "capacidad %zu, cantidad %zu, borrados %zu, carga %.3f (borrados %.3f)\n",
+            estadisticas.capacidad, estadisticas.cantidad, estadisticas.borrados, estadisticas.carga,
+            estadisticas.proporcion_borrados);
+    fprintf(salida, "distancia a la posicion original: maxima %zu\n", estadisticas.distancia_maxima);
+    imprimir_histograma(salida, estadisticas.distancias);
+    fprintf(salida, "rachas de posiciones no vacias: maxima %zu\n", estadisticas.racha_maxima);
+    imprimir_histograma(salida, estadisticas.rachas);
+
+    if (!estadisticas.contadores) {
+        fprintf(salida, "contadores desactivados, compilar hash.c con -DHASH_ESTADISTICAS\n");
+        return;
     }
+    fprintf(salida, "busquedas: %zu aciertos, %zu fallos\n", estadisticas.aciertos, estadisticas.fallos);
+    fprintf(salida, "posiciones visitadas por busqueda:\n");
+    imprimir_histograma(salida, estadisticas.sondeos);
+    fprintf(salida, "redimensiones %zu, %zu bytes movidos en %.3f ms\n", estadisticas.redimensiones,
+            estadisticas.bytes_movidos, estadisticas.segundos_redimensionando * 1e3);
+}
+
+/* ******************************************************************
+ *                         ARCHIVO MAPEADO
+ * *****************************************************************/
+
+/* El archivo tiene el encabezado, la tabla de campos, los bytes de control
+ * y al final las claves largas y los datos. En los campos, los punteros a
+ * claves y datos se reemplazan por su desplazamiento desde el principio del
+ * archivo (0 para un dato NULL), así se puede mapear en cualquier dirección.
+ * Los enteros quedan como en memoria, por lo que el archivo solo sirve en
+ * máquinas de la misma arquitectura.
+ */
+#define MAGIA_ARCHIVO "HASHMAP"
+#define VERSION_ARCHIVO 1
+#define ALINEACION_TABLA 64
+#define ALINEACION_DATO 8
+
+typedef struct encabezado{
+  char magia[8];
+  uint32_t version;
+  uint32_t largo_campo; // sizeof(campo_t), para rechazar archivos de otra arquitectura.
+  uint32_t motor;
+  uint32_t funcion;
+  uint64_t capacidad;
+  uint64_t cantidad;
+  uint64_t inicio_tabla;
+  uint64_t inicio_control;
+  uint64_t largo_archivo;
+} encabezado_t;
+
+typedef struct escritura{
+  FILE* archivo;
+  uint64_t posicion; // Fin de lo escrito en la zona de claves y datos.
+  bool ok;
+} escritura_t;
+
+static uint64_t alinear(uint64_t n, uint64_t alineacion) {
+    return (n + alineacion - 1) & ~(alineacion - 1);
+}
+
+// Agrega los bytes a la zona de claves y datos y devuelve dónde quedaron.
+static uint64_t escribir_bytes(escritura_t *escritura, const void *bytes, size_t largo, uint64_t alineacion) {
+    // Se rellena con ceros y no con fseeko, que vaciaría el buffer de stdio en cada dato.
+    static const char relleno[ALINEACION_DATO];
+    uint64_t lugar = alinear(escritura->posicion, alineacion);
+    size_t largo_relleno = lugar - escritura->posicion;
+    escritura->ok = escritura->ok && fwrite(relleno, 1, largo_relleno, escritura->archivo) == largo_relleno;
+    escritura->ok = escritura->ok && fwrite(bytes, 1, largo, escritura->archivo) == largo;
+    escritura->posicion = lugar + largo;
+    return lugar;
+}
+
+/* Arma en memoria la tabla que va al archivo, sin borrados y con la menor
+ * capacidad posible, mientras escribe las claves largas y los datos.
+ */
+static void escribir_campos(const hash_t *hash, escritura_t *escritura, hash_dato_a_bytes_t a_bytes,
+                            campo_t *tabla, unsigned char *control, size_t capacidad) {
+    for (size_t pos = 0; pos < posiciones_iter(hash) && escritura->ok; pos++) {
+        const campo_t *original = campo_iter(hash, pos);
+        if (!original) continue;
+
+        campo_t campo = *original;
+        if (!clave_corta(original)) {
+            uint64_t lugar = escribir_bytes(escritura, ver_clave(hash, original), largo_clave(original) + 1, 1);
+            campo.clave.larga.puntero = (char *) (uintptr_t) lugar;
+        }
+        void *valor = ver_valor(hash, original);
+        if (valor) {
+            size_t largo;
+            const void *bytes = a_bytes ? a_bytes(valor, &largo) : valor;
+            if (!a_bytes) largo = strlen(valor) + 1;
+            campo.valor = (void *) (uintptr_t) escribir_bytes(escritura, bytes, largo, ALINEACION_DATO);
+        }
+        colocar(hash->motor, tabla, control, capacidad, campo);
+    }
+}
+
+/* Crea un archivo temporal nuevo junto a ruta y deja su nombre en temporal.
+ * El nombre lleva el pid y un contador, así no choca con el de otro hilo o
+ * proceso que esté guardando en la misma ruta.
+ */
+static FILE *crear_temporal(const char *ruta, char **temporal) {
+    static unsigned contador;
+    size_t largo = strlen(ruta) + 48;
+    *temporal = malloc(largo);
+    if (!*temporal) return NULL;
+
+    for (size_t intento = 0; intento < 16; intento++) {
+        unsigned numero = __atomic_fetch_add(&contador, 1, __ATOMIC_RELAXED);
+        snprintf(*temporal, largo, "%s.tmp.%ld.%u", ruta, (long) getpid(), numero);
+        int descriptor = open(*temporal, O_WRONLY | O_CREAT | O_EXCL, 0666);
+        if (descriptor < 0) continue;
+        FILE *archivo = fdopen(descriptor, "wb");
+        if (archivo) return archivo;
+        close(descriptor);
+        remove(*temporal);
+        break;
+    }
+    free(*temporal);
+    *temporal = NULL;
+    return NULL;
+}
+
+/* El archivo se escribe aparte y recién al final reemplaza al de la ruta, así
+ * un hash que lo tenga mapeado sigue leyendo el anterior (truncarlo le daría
+ * SIGBUS) y si algo falla el archivo anterior queda intacto.
+ */
+bool hash_guardar_archivo(const hash_t *hash, const char *ruta, hash_dato_a_bytes_t a_bytes) {
+    if (claves_propias(hash)) return false;
+
+    size_t capacidad = capacidad_para(hash, hash->cantidad);
+    campo_t *tabla;
+    unsigned char *control;
+    if (!crear_tabla(capacidad, &tabla, &control)) return false;
+
+    char *temporal;
+    escritura_t escritura = { .archivo = crear_temporal(ruta, &temporal), .ok = true };
+    if (!escritura.archivo) {
+        free(tabla);
+        free(control);
+        return false;
+    }
+
+    encabezado_t encabezado = {
+        .magia = MAGIA_ARCHIVO, .version = VERSION_ARCHIVO, .largo_campo = sizeof(campo_t),
+        .motor = hash->motor, .funcion = hash->funcion, .capacidad = capacidad, .cantidad = hash->cantidad,
+        .inicio_tabla = alinear(sizeof(encabezado_t), ALINEACION_TABLA),
+    };
+    encabezado.inicio_control = encabezado.inicio_tabla + capacidad * sizeof(campo_t);
+    escritura.posicion = encabezado.inicio_control + capacidad;
+    escritura.ok = fseeko(escritura.archivo, (off_t) escritura.posicion, SEEK_SET) == 0;
+
+    escribir_campos(hash, &escritura, a_bytes, tabla, control, capacidad);
+    encabezado.largo_archivo = escritura.posicion;
+
+    // La tabla y el encabezado van al principio, una vez que se conocen los desplazamientos.
+    bool ok = escritura.ok && fseeko(escritura.archivo, 0, SEEK_SET) == 0 &&
+              fwrite(&encabezado, sizeof(encabezado), 1, escritura.archivo) == 1 &&
+              fseeko(escritura.archivo, (off_t) encabezado.inicio_tabla, SEEK_SET) == 0 &&
+              fwrite(tabla, sizeof(campo_t), capacidad, escritura.archivo) == capacidad &&
+              fwrite(control, 1, capacidad, escritura.archivo) == capacidad &&
+              fflush(escritura.archivo) == 0 && fsync(fileno(escritura.archivo)) == 0;
+    ok = fclose(escritura.archivo) == 0 && ok;
+    ok = ok && rename(temporal, ruta) == 0;
+
+    free(tabla);
+    free(control);
+    if (!ok) remove(temporal);
+    free(temporal);
+    return ok;
+}
+
+// La capacidad se compara dividiendo, así un valor enorme no desborda la multiplicación.
+static bool encabezado_valido(const encabezado_t *encabezado, size_t largo) {
+    return memcmp(encabezado->magia, MAGIA_ARCHIVO, sizeof(encabezado->magia)) == 0 &&
+           encabezado->version == VERSION_ARCHIVO && encabezado->largo_campo == sizeof(campo_t) &&
+           encabezado->motor <= HASH_MOTOR_ROBIN_HOOD && encabezado->funcion <= HASH_FUNCION_DJB2 &&
+           encabezado->capacidad > 0 && (encabezado->capacidad & (encabezado->capacidad - 1)) == 0 &&
+           encabezado->cantidad < encabezado->capacidad && encabezado->largo_archivo == largo &&
+           encabezado->inicio_tabla % ALINEACION_TABLA == 0 && encabezado->inicio_tabla >= sizeof(encabezado_t) &&
+           encabezado->inicio_tabla <= largo &&
+           encabezado->capacidad <= (largo - encabezado->inicio_tabla) / (sizeof(campo_t) + 1) &&
+           encabezado->inicio_control == encabezado->inicio_tabla + encabezado->capacidad * sizeof(campo_t);
+}
+
+/* Revisa cada posición de la tabla del archivo: el byte de control tiene que
+ * ser VACIO o la etiqueta del hash del campo, las claves cortas tienen que
+ * estar terminadas y las claves largas y los datos tienen que empezar dentro
+ * de la zona de claves y datos. Al haber menos elementos que posiciones
+ * queda algún VACIO, así las búsquedas que fallan terminan.
+ */
+static bool campos_validos(const char *mapa, const encabezado_t *encabezado) {
+    const campo_t *tabla = (const campo_t *) (mapa + encabezado->inicio_tabla);
+    const unsigned char *control = (const unsigned char *) mapa + encabezado->inicio_control;
+    uint64_t inicio_datos = encabezado->inicio_control + encabezado->capacidad;
+    uint64_t fin = encabezado->largo_archivo;
+
+    size_t ocupados = 0;
+    for (size_t pos = 0; pos < encabezado->capacidad; pos++) {
+        if (control[pos] == VACIO) continue;
+        const campo_t *campo = &tabla[pos];
+        if (!ocupado(control[pos]) || control[pos] != etiqueta(campo->hash)) return false;
+
+        if (clave_corta(campo)) {
+            unsigned char libre = (unsigned char) campo->clave.corta[LARGO_CLAVE_CORTA];
+            if (libre > LARGO_CLAVE_CORTA || campo->clave.corta[LARGO_CLAVE_CORTA - libre] != '\0') return false;
+        } else {
+            uint64_t lugar = (uintptr_t) campo->clave.larga.puntero;
+            if (lugar < inicio_datos || lugar >= fin || fin - lugar <= campo->clave.larga.largo ||
+                mapa[lugar + campo->clave.larga.largo] != '\0') return false;
+        }
+        uint64_t valor = (uintptr_t) campo->valor;
+        if (valor && (valor < inicio_datos || valor >= fin || valor % ALINEACION_DATO != 0)) return false;
+        ocupados++;
+    }
+    return ocupados == encabezado->cantidad;
+}
+
+hash_t *hash_cargar_mmap(const char *ruta) {
+    int descriptor = open(ruta, O_RDONLY);
+    if (descriptor < 0) return NULL;
+
+    struct stat datos;
+    void *mapa = MAP_FAILED;
+    if (fstat(descriptor, &datos) == 0 && (size_t) datos.st_size >= sizeof(encabezado_t)) {
+        mapa = mmap(NULL, (size_t) datos.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (mapa == MAP_FAILED) return NULL;
+
+    size_t largo = (size_t) datos.st_size;
+    const encabezado_t *encabezado = mapa;
+    bool valido = encabezado_valido(encabezado, largo) && campos_validos(mapa, encabezado);
+    hash_t *hash = valido ? malloc(sizeof(hash_t)) : NULL;
+    if (!hash) {
+        munmap(mapa, largo);
+        return NULL;
+    }
+
+    hash->capacidad = encabezado->capacidad;
+    hash->cantidad = encabezado->cantidad;
+    hash->borrados = 0;
+    hash->motor = encabezado->motor;
+    hash->funcion = encabezado->funcion;
+    hash_opciones_t opciones = { .motor = hash->motor };
+    leer_opciones(hash, &opciones);
+    hash->funcion_destruccion = NULL;
+    hash->tipo = (hash_tipo_clave_t) { NULL };
+    hash->tabla = (campo_t *) ((char *) mapa + encabezado->inicio_tabla);
+    hash->control = (unsigned char *) mapa + encabezado->inicio_control;
+    hash->arena = NULL;
+    hash->incremental = false;
+    hash->vieja = NULL;
+    hash->control_viejo = NULL;
+    hash->capacidad_vieja = 0;
+    hash->migrados = 0;
+    hash->mapa = mapa;
+    hash->largo_mapa = largo;
+    hash->base = (uintptr_t) mapa;
+    actualizar_umbrales(hash);
+    INICIAR_CONTADORES(hash);
+    return hash;
+}
+
+void hash_destruir(hash_t *hash) {
+
+    if (hash->mapa) {
+        munmap(hash->mapa, hash->largo_mapa);
+        free(hash);
+        return;
+    }
+
+    // Con arena y sin datos para destruir no hace falta recorrer la tabla.
+    if (!hash->arena || hash->funcion_destruccion) {
+        destruir_campos(hash, hash->tabla, hash->control, hash->capacidad);
+        if (hash->vieja) destruir_campos(hash, hash->vieja, hash->control_viejo, hash->capacidad_vieja);
+    }
+    if (hash->arena) arena_destruir(hash->arena);
     free(hash->tabla);
+    free(hash->control);
+    free(hash->vieja);
+    free(hash->control_viejo);
     free(hash);
 }
 
+/* ******************************************************************
+ *                            RECORRIDOS
+ * *****************************************************************/
+
+void hash_cursor_iniciar(hash_cursor_t *cursor, const hash_t *hash) {
+    cursor->hash = hash;
+    cursor->posicion = 0;
+}
+
+bool hash_cursor_siguiente(hash_cursor_t *cursor, const char **clave, size_t *largo, void **dato) {
+    const hash_t *hash = cursor->hash;
+    size_t pos = siguiente_ocupada(hash, cursor->posicion);
+    if (pos == posiciones_iter(hash)) {
+        cursor->posicion = pos;
+        return false;
+    }
+    cursor->posicion = pos + 1;
+
+    const campo_t *campo = campo_iter(hash, pos);
+    if (clave) *clave = ver_clave(hash, campo);
+    if (largo) *largo = largo_clave(campo);
+    if (dato) *dato = ver_valor(hash, campo);
+    return true;
+}
+
+static bool recorrer_tabla(const hash_t *hash, const campo_t *tabla, const unsigned char *control,
+                           size_t capacidad, hash_visitar_t visitar, void *extra) {
+    for (size_t inicio = 0; inicio < capacidad; inicio += 64) {
+        uint64_t mascara = ocupados_desde(control, inicio, capacidad);
+        for (; mascara; mascara &= mascara - 1) {
+            const campo_t *campo = &tabla[inicio + (size_t) __builtin_ctzll(mascara)];
+            if (!visitar(ver_clave(hash, campo), largo_clave(campo), ver_valor(hash, campo), extra)) return false;
+        }
+    }
+    return true;
+}
+
+void hash_recorrer(const hash_t *hash, hash_visitar_t visitar, void *extra) {
+    if (!recorrer_tabla(hash, hash->tabla, hash->control, hash->capacidad, visitar, extra)) return;
+    if (hash->vieja) recorrer_tabla(hash, hash->vieja, hash->control_viejo, hash->capacidad_vieja, visitar, extra);
+}
+
+/* ******************************************************************
+ *                            ITERADOR
+ * *****************************************************************/
+
 hash_iter_t *hash_iter_crear(const hash_t *hash){
 
     hash_iter_t *hash_iter = malloc(sizeof(hash_iter_t));
@@ -212,14 +1797,7 @@ hash_iter_t *hash_iter_crear(const hash_t *hash){
     if(!hash_iter) return NULL;
 
     hash_iter->hash = hash;
-
-    size_t pos = 0;
-    while(hash->tabla[pos].estado != OCUPADO){
-        pos++;
-        if( pos == hash->capacidad) break;
-    }
-    if(pos != hash->capacidad) hash_iter->campo_act = hash->tabla[pos];
-    hash_iter->posicion = pos;
+    hash_iter->posicion = siguiente_ocupada(hash, 0);
 
     return hash_iter;
 
@@ -227,25 +1805,20 @@ hash_iter_t *hash_iter_crear(const hash_t *hash){
 
 bool hash_iter_avanzar(hash_iter_t *iter){
     if(hash_iter_al_final(iter)) return false;
-    while (!hash_iter_al_final(iter))
-    {
-        iter->posicion++;
-        if(hash_iter_al_final(iter)) break;
-        if(iter->hash->tabla[iter->posicion].estado == OCUPADO) break;
-    }
+    iter->posicion = siguiente_ocupada(iter->hash, iter->posicion + 1);
     return true;
-    
+
 }
 
 const char *hash_iter_ver_actual(const hash_iter_t *iter){
     if(hash_iter_al_final(iter)) return NULL;
-    return iter->hash->tabla[iter->posicion].clave;
+    return ver_clave(iter->hash, campo_iter(iter->hash, iter->posicion));
 }
 
 bool hash_iter_al_final(const hash_iter_t *iter){
-    return iter->posicion == iter->hash->capacidad;
+    return iter->posicion == posiciones_iter(iter->hash);
 }
 
 void hash_iter_destruir(hash_iter_t *iter){
     free(iter);
-}
\ No newline at end of file
+}
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 
 // Los structs deben llamarse "hash" y "hash_iter".
 struct hash;
@@ -14,10 +15,88 @@ typedef struct hash_iter hash_iter_t;
 // tipo de función para destruir dato
 typedef void (*hash_destruir_dato_t)(void *);
 
+// Estrategia para resolver colisiones.
+// HASH_MOTOR_LINEAL: sondeo lineal, los borrados dejan una marca en la tabla.
+// HASH_MOTOR_ROBIN_HOOD: sondeo lineal donde las claves más lejos de su
+// posición original desplazan a las más cercanas; las búsquedas fallidas
+// terminan antes y los borrados no dejan marcas. Admite más carga antes de
+// redimensionar.
+typedef enum hash_motor {
+    HASH_MOTOR_LINEAL,
+    HASH_MOTOR_ROBIN_HOOD
+} hash_motor_t;
+
 /* Crea el hash
  */
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
 
+// Función de hash para las claves.
+// HASH_FUNCION_WYHASH: procesa la clave de a 8 bytes y dispersa bien claves
+// secuenciales. Es la función por omisión.
+// HASH_FUNCION_DJB2: la función original, por compatibilidad.
+typedef enum hash_funcion {
+    HASH_FUNCION_WYHASH,
+    HASH_FUNCION_DJB2
+} hash_funcion_t;
+
+/* Funciones para usar claves de un tipo propio (enteros, structs, ...) en
+ * lugar de cadenas. hashear e iguales son obligatorias. Si copiar es NULL el
+ * hash guarda el puntero que recibe, y la clave tiene que seguir existiendo
+ * mientras esté en el hash; si no, guarda lo que devuelva copiar (NULL si no
+ * hay memoria). liberar, si no es NULL, recibe cada clave guardada al
+ * borrarla o al destruir el hash.
+ */
+typedef struct hash_tipo_clave {
+    unsigned long (*hashear)(const void *clave);
+    bool (*iguales)(const void *a, const void *b);
+    void *(*copiar)(const void *clave);
+    void (*liberar)(void *clave);
+} hash_tipo_clave_t;
+
+// Opciones de creación del hash. Los campos en cero toman el valor por omisión.
+typedef struct hash_opciones {
+    hash_motor_t motor;
+    hash_funcion_t funcion;
+    // Guarda las copias de las claves en bloques grandes en lugar de pedir
+    // memoria para cada una; las claves borradas se reutilizan y
+    // hash_destruir libera todos los bloques juntos.
+    bool claves_en_arena;
+    // Al redimensionar no mueve toda la tabla de una vez: la vieja y la nueva
+    // conviven y cada guardado o borrado mueve unas pocas posiciones, así
+    // ninguna operación tarda mucho más que las demás. Las búsquedas no
+    // modifican el hash y miran las dos tablas.
+    bool redimension_incremental;
+    // Claves de un tipo propio, que se usan con hash_guardar_clave y demás.
+    // Las funciones se copian al crear el hash. No se combina con
+    // claves_en_arena (hash_crear_opciones devuelve NULL), y estos hashes no
+    // se pueden guardar en un archivo.
+    const hash_tipo_clave_t *tipo_clave;
+    // Capacidad con la que empieza la tabla, redondeada a una potencia de
+    // dos; al achicarse no baja de ella. Por omisión es 32.
+    size_t capacidad_inicial;
+    // Fracción de la tabla ocupada (elementos más borrados) a partir de la
+    // cual crece, menor que 1. Por omisión es 0.7, o 0.9 con Robin Hood. Más
+    // carga usa menos memoria a cambio de sondeos más largos.
+    double carga_maxima;
+    // Por cuánto se multiplica la capacidad al crecer, una potencia de dos.
+    // Por omisión es 2.
+    size_t factor_crecimiento;
+    // Carga por debajo de la cual la tabla se achica a la mitad al borrar.
+    // Tiene que ser menor que carga_maxima / factor_crecimiento, así la tabla
+    // no se achica apenas crece. Por omisión es la mitad de ese valor.
+    double carga_minima;
+} hash_opciones_t;
+
+/* Crea el hash con las opciones indicadas. Devuelve NULL si no hay memoria o
+ * si las opciones no son válidas.
+ */
+hash_t *hash_crear_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones);
+
+/* Crea el hash usando la estrategia de colisiones indicada. hash_crear
+ * equivale a usar HASH_MOTOR_LINEAL.
+ */
+hash_t *hash_crear_motor(hash_destruir_dato_t destruir_dato, hash_motor_t motor);
+
 /* Guarda un elemento en el hash, si la clave ya se encuentra en la
  * estructura, la reemplaza. De no poder guardarlo devuelve false.
  * Pre: La estructura hash fue inicializada
@@ -25,6 +104,15 @@ hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
  */
 bool hash_guardar(hash_t *hash, const char *clave, void *dato);
 
+/* Busca la clave y devuelve un puntero al dato asociado, que se puede leer o
+ * reemplazar sin volver a buscar. Si la clave no estaba, la guarda con el
+ * dato indicado; si ya estaba, dato no se usa. Si guardado no es NULL indica
+ * si la clave se agregó. Devuelve NULL si no se pudo guardar. El puntero deja
+ * de ser válido al modificar el hash.
+ * Pre: La estructura hash fue inicializada
+ */
+void **hash_obtener_o_guardar(hash_t *hash, const char *clave, void *dato, bool *guardado);
+
 /* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
  * NULL si el dato no estaba.
  * Pre: La estructura hash fue inicializada
@@ -39,16 +127,159 @@ void *hash_borrar(hash_t *hash, const char *clave);
  */
 void *hash_obtener(const hash_t *hash, const char *clave);
 
+/* Obtiene de una vez los valores de 'cantidad' claves: datos[i] queda con el
+ * valor de claves[i], o NULL si no está. Es más rápido que llamar a
+ * hash_obtener con cada clave cuando la tabla no entra en la caché.
+ * Pre: La estructura hash fue inicializada, datos tiene lugar para
+ * 'cantidad' elementos
+ */
+void hash_obtener_lote(const hash_t *hash, const char *const *claves, size_t cantidad, void **datos);
+
 /* Determina si clave pertenece o no al hash.
  * Pre: La estructura hash fue inicializada
  */
 bool hash_pertenece(const hash_t *hash, const char *clave);
 
+/* Variantes de guardar, borrar, obtener y pertenece para claves de 'largo'
+ * bytes, que pueden contener '\0' y no necesitan terminar en '\0'. Una clave
+ * de texto guardada con hash_guardar es la misma que sus strlen(clave) bytes.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_guardar_bytes(hash_t *hash, const void *clave, size_t largo, void *dato);
+void *hash_borrar_bytes(hash_t *hash, const void *clave, size_t largo);
+void *hash_obtener_bytes(const hash_t *hash, const void *clave, size_t largo);
+bool hash_pertenece_bytes(const hash_t *hash, const void *clave, size_t largo);
+
+/* Variantes de guardar, borrar, obtener y pertenece para hashes creados con
+ * tipo_clave, donde la clave es un puntero a un valor del tipo propio. En un
+ * hash de cadenas equivalen a las funciones originales, y en un hash con
+ * tipo_clave las originales (hash_guardar, hash_obtener, hash_pertenece,
+ * hash_borrar) también toman la clave como un valor del tipo propio y nunca
+ * la leen como cadena. El iterador y el cursor devuelven el puntero guardado
+ * como clave, con largo 0.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_guardar_clave(hash_t *hash, const void *clave, void *dato);
+void *hash_borrar_clave(hash_t *hash, const void *clave);
+void *hash_obtener_clave(const hash_t *hash, const void *clave);
+bool hash_pertenece_clave(const hash_t *hash, const void *clave);
+
 /* Devuelve la cantidad de elementos del hash.
  * Pre: La estructura hash fue inicializada
  */
 size_t hash_cantidad(const hash_t *hash);
 
+/* Guarda de una vez 'cantidad' claves con sus datos (datos[i] es el de
+ * claves[i]) en un hash vacío. Dimensiona la tabla una sola vez y reparte
+ * entre 'hilos' hilos (0 usa uno por procesador) el cálculo de los hashes y
+ * la ubicación de las claves. Si el hash no está vacío, o si usa claves de
+ * un tipo propio, las guarda de a una. Devuelve false si no hay memoria; si
+ * el hash de cadenas estaba vacío, queda vacío.
+ * Pre: La estructura hash fue inicializada, las claves son distintas
+ */
+bool hash_cargar(hash_t *hash, const char *const *claves, void *const *datos, size_t cantidad, size_t hilos);
+
+/* Agranda la tabla de una vez para que entren 'cantidad' elementos sin
+ * redimensionar, antes de guardar muchos elementos de los que se conoce la
+ * cantidad. Al borrar, la tabla no se achica por debajo de lo reservado
+ * hasta llamar a hash_compactar. Devuelve false si no hay memoria o si
+ * 'cantidad' no entra en ninguna tabla; el hash queda como estaba.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_reservar(hash_t *hash, size_t cantidad);
+
+/* Lleva la tabla a la menor capacidad en la que entran los elementos que
+ * tiene, liberando la memoria que sobra y lo reservado con hash_reservar. Al
+ * borrar la tabla también se achica sola, pero solo cuando queda muy vacía.
+ * Devuelve false si no hay memoria; el hash queda como estaba.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_compactar(hash_t *hash);
+
+/* Devuelve el hash que la tabla usa para la clave de 'largo' bytes. Sirve
+ * para repartir claves entre varias tablas creadas con las mismas opciones;
+ * conviene usar los bits altos, porque la tabla ubica las claves con los bajos.
+ * Pre: La estructura hash fue inicializada
+ */
+unsigned long hash_calcular(const hash_t *hash, const void *clave, size_t largo);
+
+/* Función de hash por omisión (HASH_FUNCION_WYHASH), para otras estructuras
+ * que necesiten hashear claves igual que el hash.
+ */
+unsigned long hash_wyhash(const void *clave, size_t largo);
+
+// Tipo de función para guardar un dato en un archivo: devuelve sus bytes y
+// deja en largo cuántos son.
+typedef const void *(*hash_dato_a_bytes_t)(const void *dato, size_t *largo);
+
+/* Guarda el hash en el archivo de la ruta indicada, para abrirlo después con
+ * hash_cargar_mmap. De cada dato se guardan los bytes que devuelve a_bytes;
+ * si es NULL, los datos se toman como cadenas terminadas en '\0'. Los datos
+ * NULL se siguen leyendo como NULL. El archivo se escribe con otro nombre y
+ * reemplaza al anterior recién al terminar: los hashes que tengan mapeado el
+ * anterior lo siguen viendo, y si no se pudo escribir (devuelve false) el
+ * anterior queda como estaba.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_guardar_archivo(const hash_t *hash, const char *ruta, hash_dato_a_bytes_t a_bytes);
+
+/* Abre un hash guardado con hash_guardar_archivo mapeando el archivo en
+ * memoria, sin copiar ni rehashear nada. El hash es de solo lectura: guardar
+ * y borrar fallan. Los datos son punteros a sus bytes dentro del archivo,
+ * alineados a 8 y válidos hasta destruir el hash. El archivo solo se puede
+ * abrir en una máquina de la misma arquitectura. Devuelve NULL si no se
+ * puede abrir o no es un archivo de hash válido: para eso recorre la tabla
+ * una vez y revisa los bytes de control y que cada clave y cada dato empiece
+ * dentro del archivo. El largo de un dato lo conoce solo quien lo guardó,
+ * así que leerlo más allá del final del archivo no se detecta.
+ */
+hash_t *hash_cargar_mmap(const char *ruta);
+
+/* Devuelve la cantidad de posiciones de la tabla que se visitan al buscar
+ * la clave, esté o no guardada. Sirve para medir el rendimiento del hash.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_largo_sondeo(const hash_t *hash, const char *clave);
+
+#define HASH_BUCKETS_ESTADISTICAS 16
+
+/* Estadísticas del hash, para ajustar la carga o la capacidad con datos
+ * reales. Los histogramas agrupan por potencias de dos: el bucket 0 cuenta
+ * los 0, el 1 los 1, el 2 de 2 a 3, el 3 de 4 a 7, y el último el resto.
+ */
+typedef struct hash_estadisticas {
+    // Estado actual, se calcula al pedirlas recorriendo la tabla.
+    size_t capacidad;
+    size_t cantidad;
+    size_t borrados;
+    double carga;               // (cantidad + borrados) / capacidad
+    double proporcion_borrados; // borrados / capacidad
+    size_t distancias[HASH_BUCKETS_ESTADISTICAS]; // De cada elemento a su posición original.
+    size_t distancia_maxima;
+    size_t rachas[HASH_BUCKETS_ESTADISTICAS]; // Largos de las rachas de posiciones no vacías.
+    size_t racha_maxima;
+    // Contadores desde que se creó el hash. Se llevan solo si hash.c se
+    // compila con -DHASH_ESTADISTICAS, que agrega unas sumas atómicas a cada
+    // búsqueda; si no, contadores es false y el resto queda en cero.
+    bool contadores;
+    size_t aciertos;
+    size_t fallos;
+    size_t sondeos[HASH_BUCKETS_ESTADISTICAS]; // Posiciones visitadas por cada búsqueda.
+    size_t redimensiones;
+    size_t bytes_movidos;
+    double segundos_redimensionando;
+} hash_estadisticas_t;
+
+/* Completa las estadísticas del hash. Recorre toda la tabla.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas);
+
+/* Imprime las estadísticas del hash, con sus histogramas, en salida.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_estadisticas_imprimir(const hash_t *hash, FILE *salida);
+
 /* Destruye la estructura liberando la memoria pedida y llamando a la función
  * destruir para cada par (clave, dato).
  * Pre: La estructura hash fue inicializada
@@ -56,6 +287,39 @@ size_t hash_cantidad(const hash_t *hash);
  */
 void hash_destruir(hash_t *hash);
 
+/* Recorridos del hash */
+
+/* Cursor para recorrer el hash sin pedir memoria: se declara en la pila y se
+ * inicializa con hash_cursor_iniciar. Sus campos no se deben usar.
+ */
+typedef struct hash_cursor {
+    const hash_t *hash;
+    size_t posicion;
+} hash_cursor_t;
+
+/* Prepara el cursor para recorrer el hash desde el principio.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_cursor_iniciar(hash_cursor_t *cursor, const hash_t *hash);
+
+/* Pasa al siguiente elemento y deja su clave, el largo de la clave y su dato
+ * (los punteros NULL se ignoran). El primer llamado da el primer elemento.
+ * Devuelve false cuando no quedan más. La clave no se puede modificar ni
+ * liberar. El hash no se puede modificar mientras se lo recorre.
+ * Pre: El cursor fue iniciado
+ */
+bool hash_cursor_siguiente(hash_cursor_t *cursor, const char **clave, size_t *largo, void **dato);
+
+// Tipo de función para visitar cada elemento del hash, devuelve false para cortar el recorrido.
+typedef bool (*hash_visitar_t)(const char *clave, size_t largo, void *dato, void *extra);
+
+/* Llama a visitar con cada elemento del hash y 'extra', hasta que visitar
+ * devuelva false. Es la forma más rápida de recorrer todo el hash. visitar
+ * no puede modificar el hash.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_recorrer(const hash_t *hash, hash_visitar_t visitar, void *extra);
+
 /* Iterador del hash */
 
 // Crea iterador
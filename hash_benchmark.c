@@ -0,0 +1,597 @@
+/*
+ * hash_benchmark.c
+ * Mediciones de rendimiento para el tipo de dato abstracto Tabla de Hash.
+ *
+ * Compilación (programa aparte, no usa main.c):
+ *
+ *     gcc -O2 -std=gnu99 -pthread -o benchmark hash_benchmark.c hash.c -lm
+ *
+ * Uso:
+ *
+ *     ./benchmark [-n claves] [-o operaciones] [-k secuencial|aleatoria|url]
+ *                 [-a uniforme|zipf] [-e aciertos] [-r rotaciones] [-t tandas]
+ *                 [-m lineal|robin_hood] [-c malloc|arena] [-f wyhash|djb2]
+ *                 [-l lote] [-i] [-p] [-j hilos] [-g archivo] [-x] [-s semilla]
+ *
+ * Para cada fase (inserción, búsqueda, rotación de borrados e iteración)
+ * imprime operaciones por segundo, latencias p50/p99/p999/máxima y, en la
+ * búsqueda, el largo de sondeo promedio, máximo y su histograma.
+ *
+ * La fase de lotes compara buscar 'lote' claves con un bucle de hash_obtener
+ * contra buscarlas con hash_obtener_lote.
+ *
+ * Con -i la tabla se redimensiona de forma incremental; conviene comparar la
+ * latencia máxima de la inserción con y sin esta opción.
+ *
+ * Con -p se llama a hash_reservar antes de la inserción, así la tabla no se
+ * redimensiona mientras se guardan las claves.
+ *
+ * Con -j la inserción se reemplaza por una sola llamada a hash_cargar con
+ * todas las claves, repartida en 'hilos' hilos (0 usa uno por procesador).
+ *
+ * Con -g al final se guarda la tabla en 'archivo', se la vuelve a abrir con
+ * hash_cargar_mmap y se repite la búsqueda sobre la tabla mapeada. Conviene
+ * comparar el tiempo de apertura con el de la inserción.
+ *
+ * Con -x al final se imprimen las estadísticas del hash. Compilando además
+ * con -DHASH_ESTADISTICAS se ven también los contadores de búsquedas y
+ * redimensiones.
+ *
+ * Con -t se repiten 'tandas' veces la rotación y la búsqueda, para simular
+ * tráfico continuo de altas y bajas y ver si la búsqueda se degrada.
+ *
+ * hash_benchmark_resultados.txt tiene mediciones de referencia, con la
+ * máquina, el compilador y los parámetros con los que se tomaron.
+ */
+
+#include "benchmark_comun.h"
+#include "hash.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <unistd.h>  // getopt
+
+// Lugar reservado por clave: las URL miden ~80 bytes, el resto menos de 24.
+#define LARGO_MAX_CLAVE 128
+#define LARGO_CLAVE_CORTA 24
+#define BUCKETS_HISTOGRAMA 16
+#define ZIPF_EXPONENTE 0.99
+
+// Las claves de los fallos se generan a partir de este identificador, de
+// forma que nunca coincidan con las claves guardadas.
+#define ID_FALLOS (1ULL << 40)
+
+typedef enum tipo_clave {
+    CLAVE_SECUENCIAL, CLAVE_ALEATORIA, CLAVE_URL
+} tipo_clave_t;
+
+typedef enum acceso {
+    ACCESO_UNIFORME, ACCESO_ZIPF
+} acceso_t;
+
+typedef struct config {
+    size_t claves;
+    size_t operaciones;
+    size_t rotaciones;
+    size_t tandas;
+    size_t lote;
+    double aciertos;
+    tipo_clave_t tipo_clave;
+    size_t largo_clave;
+    acceso_t acceso;
+    hash_opciones_t opciones;
+    bool reservar;
+    bool cargar;
+    size_t hilos_carga;
+    const char *archivo;
+    bool estadisticas;
+    uint64_t semilla;
+} config_t;
+
+typedef struct medicion {
+    uint64_t *latencias;
+    size_t cantidad;
+    uint64_t total_ns;
+} medicion_t;
+
+/* ******************************************************************
+ *                        FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+static uint64_t estado_rng;
+
+static double aleatorio_unitario(void) {
+    return (double) (aleatorio(&estado_rng) >> 11) / (double) (1ULL << 53);
+}
+
+static void escribir_clave(char *destino, tipo_clave_t tipo, uint64_t id) {
+    switch (tipo) {
+        case CLAVE_SECUENCIAL:
+            sprintf(destino, "%08llu", (unsigned long long) id);
+            break;
+        case CLAVE_ALEATORIA:
+            escribir_clave_aleatoria(destino, LARGO_CLAVE_CORTA, id);
+            break;
+        case CLAVE_URL:
+            sprintf(destino, "https://www.ejemplo.com.ar/usuarios/%010llu/sesiones/%016llx/perfil.html",
+                    (unsigned long long) id, (unsigned long long) mezclar(id));
+            break;
+    }
+}
+
+/* Tabla acumulada de la distribución de Zipf sobre 'n' rangos. */
+static double *zipf_crear(size_t n) {
+    double *acumulada = malloc(n * sizeof(double));
+    if (!acumulada) return NULL;
+
+    double suma = 0;
+    for (size_t i = 0; i < n; i++) {
+        suma += 1.0 / pow((double) (i + 1), ZIPF_EXPONENTE);
+        acumulada[i] = suma;
+    }
+    for (size_t i = 0; i < n; i++) acumulada[i] /= suma;
+    return acumulada;
+}
+
+static size_t zipf_elegir(const double *acumulada, size_t n) {
+    double u = aleatorio_unitario();
+    size_t inicio = 0, fin = n - 1;
+    while (inicio < fin) {
+        size_t medio = inicio + (fin - inicio) / 2;
+        if (acumulada[medio] < u) inicio = medio + 1;
+        else fin = medio;
+    }
+    return inicio;
+}
+
+static size_t elegir_indice(const config_t *config, const double *zipf) {
+    if (config->acceso == ACCESO_ZIPF) return zipf_elegir(zipf, config->claves);
+    return (size_t) (aleatorio(&estado_rng) % config->claves);
+}
+
+static char *clave_en(char *claves, const config_t *config, size_t i) {
+    return claves + i * config->largo_clave;
+}
+
+static bool medicion_crear(medicion_t *medicion, size_t cantidad) {
+    medicion->latencias = malloc((cantidad ? cantidad : 1) * sizeof(uint64_t));
+    medicion->cantidad = 0;
+    medicion->total_ns = 0;
+    return medicion->latencias != NULL;
+}
+
+static void medicion_agregar(medicion_t *medicion, uint64_t ns) {
+    medicion->latencias[medicion->cantidad++] = ns;
+    medicion->total_ns += ns;
+}
+
+static int comparar_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t percentil(const medicion_t *medicion, double p) {
+    if (medicion->cantidad == 0) return 0;
+    size_t pos = (size_t) (p * (double) (medicion->cantidad - 1));
+    return medicion->latencias[pos];
+}
+
+static void medicion_imprimir(const char *fase, medicion_t *medicion) {
+    qsort(medicion->latencias, medicion->cantidad, sizeof(uint64_t), comparar_u64);
+    double segundos = (double) medicion->total_ns / 1e9;
+    double ops_seg = segundos > 0 ? (double) medicion->cantidad / segundos : 0;
+
+    printf("%-12s %10zu %14.0f %9llu %9llu %9llu %11llu\n", fase, medicion->cantidad, ops_seg,
+           (unsigned long long) percentil(medicion, 0.5),
+           (unsigned long long) percentil(medicion, 0.99),
+           (unsigned long long) percentil(medicion, 0.999),
+           (unsigned long long) percentil(medicion, 1.0));
+}
+
+static void medicion_destruir(medicion_t *medicion) {
+    free(medicion->latencias);
+}
+
+/* Acumula largos de sondeo en buckets de potencias de dos: 1, 2, 3-4, 5-8... */
+static size_t bucket_sondeo(size_t largo) {
+    size_t bucket = 0;
+    while (largo > 1 && bucket < BUCKETS_HISTOGRAMA - 1) {
+        largo = (largo + 1) / 2;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void imprimir_sondeos(const size_t *histograma, size_t total, size_t suma, size_t maximo) {
+    if (total == 0) return;
+    printf("\nsondeo: promedio %.3f, maximo %zu\n", (double) suma / (double) total, maximo);
+    size_t desde = 1;
+    for (size_t i = 0; i < BUCKETS_HISTOGRAMA; i++) {
+        size_t hasta = (size_t) 1 << i;
+        if (histograma[i]) {
+            printf("  %6zu-%-6zu %10zu %6.2f%%\n", desde, hasta, histograma[i],
+                   100.0 * (double) histograma[i] / (double) total);
+        }
+        desde = hasta + 1;
+    }
+}
+
+/* ******************************************************************
+ *                              FASES
+ * *****************************************************************/
+
+static bool fase_insercion(hash_t *hash, const config_t *config, char *claves) {
+    medicion_t medicion;
+    if (!medicion_crear(&medicion, config->claves)) return false;
+
+    bool ok = true;
+    for (size_t i = 0; i < config->claves && ok; i++) {
+        uint64_t inicio = ahora_ns();
+        ok = hash_guardar(hash, clave_en(claves, config, i), clave_en(claves, config, i));
+        medicion_agregar(&medicion, ahora_ns() - inicio);
+    }
+
+    medicion_imprimir("insercion", &medicion);
+    medicion_destruir(&medicion);
+    return ok;
+}
+
+static bool fase_busqueda(hash_t *hash, const config_t *config, char *claves,
+                          const double *zipf) {
+    medicion_t medicion;
+    if (!medicion_crear(&medicion, config->operaciones)) return false;
+
+    size_t histograma[BUCKETS_HISTOGRAMA] = {0};
+    size_t suma_sondeos = 0, max_sondeo = 0;
+    char clave_fallo[LARGO_MAX_CLAVE];
+    bool ok = true;
+
+    for (size_t i = 0; i < config->operaciones; i++) {
+        const char *clave;
+        bool acierto = aleatorio_unitario() < config->aciertos;
+        if (acierto) {
+            clave = clave_en(claves, config, elegir_indice(config, zipf));
+        } else {
+            escribir_clave(clave_fallo, config->tipo_clave, ID_FALLOS + aleatorio(&estado_rng) % config->claves);
+            clave = clave_fallo;
+        }
+
+        uint64_t inicio = ahora_ns();
+        void *valor = hash_obtener(hash, clave);
+        medicion_agregar(&medicion, ahora_ns() - inicio);
+        if (acierto != (valor != NULL)) ok = false;
+
+        size_t largo = hash_largo_sondeo(hash, clave);
+        histograma[bucket_sondeo(largo)]++;
+        suma_sondeos += largo;
+        if (largo > max_sondeo) max_sondeo = largo;
+    }
+
+    medicion_imprimir("busqueda", &medicion);
+    medicion_destruir(&medicion);
+    imprimir_sondeos(histograma, config->operaciones, suma_sondeos, max_sondeo);
+    return ok;
+}
+
+/* Busca las mismas claves en lotes, primero con un bucle de hash_obtener y
+ * después con hash_obtener_lote. Se mide cada lote entero y se reparte su
+ * tiempo entre sus claves. */
+static bool fase_lote(hash_t *hash, const config_t *config, char *claves, const double *zipf) {
+    medicion_t mediciones[2];
+    const char *nombres[] = {"bucle", "lote"};
+    const char **lote = malloc(config->lote * sizeof(char *));
+    char *fallos = malloc(config->lote * config->largo_clave);
+    bool *aciertos = malloc(config->lote * sizeof(bool));
+    void **datos = malloc(config->lote * sizeof(void *));
+    bool ok = lote && fallos && aciertos && datos && medicion_crear(&mediciones[0], config->operaciones);
+    if (ok && !medicion_crear(&mediciones[1], config->operaciones)) {
+        medicion_destruir(&mediciones[0]);
+        ok = false;
+    }
+    if (!ok) {
+        free(lote);
+        free(fallos);
+        free(aciertos);
+        free(datos);
+        return false;
+    }
+
+    // Las dos pasadas recorren la misma secuencia de claves.
+    uint64_t estado_inicial = estado_rng;
+    for (int pasada = 0; pasada < 2; pasada++) {
+        estado_rng = estado_inicial;
+        size_t hechas = 0;
+        while (hechas < config->operaciones) {
+            size_t n = config->operaciones - hechas < config->lote ? config->operaciones - hechas : config->lote;
+            for (size_t i = 0; i < n; i++) {
+                aciertos[i] = aleatorio_unitario() < config->aciertos;
+                if (aciertos[i]) {
+                    lote[i] = clave_en(claves, config, elegir_indice(config, zipf));
+                } else {
+                    char *fallo = clave_en(fallos, config, i);
+                    escribir_clave(fallo, config->tipo_clave, ID_FALLOS + aleatorio(&estado_rng) % config->claves);
+                    lote[i] = fallo;
+                }
+            }
+
+            uint64_t inicio = ahora_ns();
+            if (pasada == 0) {
+                for (size_t i = 0; i < n; i++) datos[i] = hash_obtener(hash, lote[i]);
+            } else {
+                hash_obtener_lote(hash, lote, n, datos);
+            }
+            uint64_t por_clave = (ahora_ns() - inicio) / n;
+
+            for (size_t i = 0; i < n; i++) {
+                medicion_agregar(&mediciones[pasada], por_clave);
+                if (aciertos[i] != (datos[i] != NULL)) ok = false;
+            }
+            hechas += n;
+        }
+        medicion_imprimir(nombres[pasada], &mediciones[pasada]);
+        medicion_destruir(&mediciones[pasada]);
+    }
+
+    free(lote);
+    free(fallos);
+    free(aciertos);
+    free(datos);
+    return ok;
+}
+
+/* Borra una clave guardada al azar y guarda una nueva en su lugar, de forma
+ * que la cantidad de elementos se mantiene constante. */
+static bool fase_rotacion(hash_t *hash, const config_t *config, char *claves,
+                          uint64_t *siguiente_id) {
+    medicion_t borrados, inserciones;
+    if (!medicion_crear(&borrados, config->rotaciones)) return false;
+    if (!medicion_crear(&inserciones, config->rotaciones)) {
+        medicion_destruir(&borrados);
+        return false;
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < config->rotaciones && ok; i++) {
+        char *clave = clave_en(claves, config, (size_t) (aleatorio(&estado_rng) % config->claves));
+
+        uint64_t inicio = ahora_ns();
+        ok = hash_borrar(hash, clave) == clave;
+        medicion_agregar(&borrados, ahora_ns() - inicio);
+
+        escribir_clave(clave, config->tipo_clave, (*siguiente_id)++);
+
+        inicio = ahora_ns();
+        ok = ok && hash_guardar(hash, clave, clave);
+        medicion_agregar(&inserciones, ahora_ns() - inicio);
+    }
+
+    medicion_imprimir("borrado", &borrados);
+    medicion_imprimir("reinsercion", &inserciones);
+    medicion_destruir(&borrados);
+    medicion_destruir(&inserciones);
+    return ok;
+}
+
+static bool fase_carga(hash_t *hash, const config_t *config, char *claves) {
+    const char **lista = malloc(config->claves * sizeof(char *));
+    if (!lista) return false;
+    for (size_t i = 0; i < config->claves; i++) lista[i] = clave_en(claves, config, i);
+
+    uint64_t inicio = ahora_ns();
+    bool ok = hash_cargar(hash, lista, (void *const *) lista, config->claves, config->hilos_carga);
+    uint64_t total = ahora_ns() - inicio;
+    free(lista);
+
+    printf("carga: %zu claves en %.3f ms, %.0f claves/seg\n", config->claves, (double) total / 1e6,
+           (double) config->claves / ((double) total / 1e9));
+    return ok && hash_cantidad(hash) == config->claves;
+}
+
+static bool fase_archivo(const hash_t *hash, const config_t *config, char *claves, const double *zipf) {
+    uint64_t inicio = ahora_ns();
+    bool ok = hash_guardar_archivo(hash, config->archivo, NULL);
+    uint64_t guardado = ahora_ns() - inicio;
+    if (!ok) return false;
+
+    inicio = ahora_ns();
+    hash_t *mapeado = hash_cargar_mmap(config->archivo);
+    uint64_t apertura = ahora_ns() - inicio;
+    if (!mapeado) return false;
+
+    printf("\narchivo: guardado en %.3f ms, mapeado en %.3f ms\n", (double) guardado / 1e6,
+           (double) apertura / 1e6);
+    ok = hash_cantidad(mapeado) == hash_cantidad(hash) && fase_busqueda(mapeado, config, claves, zipf);
+    hash_destruir(mapeado);
+    return ok;
+}
+
+static bool sumar_largo(const char *clave, size_t largo, void *dato, void *extra) {
+    (void) clave;
+    size_t *largo_total = extra;
+    *largo_total += largo + (dato != NULL);
+    return true;
+}
+
+static void imprimir_recorrido(const char *nombre, size_t recorridos, size_t largo_total, uint64_t total) {
+    printf("%-10s %zu claves (%zu bytes) en %.3f ms, %.1f ns/clave\n", nombre, recorridos, largo_total,
+           (double) total / 1e6, recorridos ? (double) total / (double) recorridos : 0);
+}
+
+/* Recorre todo el hash leyendo cada clave y su dato de tres formas: con el
+ * iterador más hash_obtener, con un cursor y con hash_recorrer. */
+static bool fase_iteracion(const hash_t *hash) {
+    printf("\niteracion\n");
+    uint64_t inicio = ahora_ns();
+    hash_iter_t *iter = hash_iter_crear(hash);
+    if (!iter) return false;
+
+    size_t recorridos = 0;
+    size_t largo_total = 0;
+    while (!hash_iter_al_final(iter)) {
+        const char *clave = hash_iter_ver_actual(iter);
+        largo_total += strlen(clave) + (hash_obtener(hash, clave) != NULL);
+        recorridos++;
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    imprimir_recorrido("iterador", recorridos, largo_total, ahora_ns() - inicio);
+    bool ok = recorridos == hash_cantidad(hash);
+
+    inicio = ahora_ns();
+    hash_cursor_t cursor;
+    hash_cursor_iniciar(&cursor, hash);
+    size_t largo;
+    void *dato;
+    recorridos = largo_total = 0;
+    while (hash_cursor_siguiente(&cursor, NULL, &largo, &dato)) {
+        largo_total += largo + (dato != NULL);
+        recorridos++;
+    }
+    imprimir_recorrido("cursor", recorridos, largo_total, ahora_ns() - inicio);
+    ok = ok && recorridos == hash_cantidad(hash);
+
+    inicio = ahora_ns();
+    largo_total = 0;
+    hash_recorrer(hash, sumar_largo, &largo_total);
+    imprimir_recorrido("recorrer", recorridos, largo_total, ahora_ns() - inicio);
+    return ok;
+}
+
+/* ******************************************************************
+ *                        PROGRAMA PRINCIPAL
+ * *****************************************************************/
+
+static void uso(const char *programa) {
+    fprintf(stderr, "uso: %s [-n claves] [-o operaciones] [-k secuencial|aleatoria|url]\n"
+                    "          [-a uniforme|zipf] [-e aciertos] [-r rotaciones] [-t tandas]\n"
+                    "          [-m lineal|robin_hood] [-c malloc|arena] [-f wyhash|djb2]\n"
+                    "          [-l lote] [-i] [-p] [-j hilos] [-g archivo] [-x] [-s semilla]\n", programa);
+}
+
+static bool leer_config(config_t *config, int argc, char *argv[]) {
+    config->claves = 1000000;
+    config->operaciones = 1000000;
+    config->rotaciones = 1000000;
+    config->tandas = 1;
+    config->lote = 256;
+    config->aciertos = 0.5;
+    config->tipo_clave = CLAVE_SECUENCIAL;
+    config->acceso = ACCESO_UNIFORME;
+    config->opciones = (hash_opciones_t) { .motor = HASH_MOTOR_LINEAL };
+    config->reservar = false;
+    config->cargar = false;
+    config->hilos_carga = 0;
+    config->archivo = NULL;
+    config->estadisticas = false;
+    config->semilla = 42;
+
+    int opcion;
+    while ((opcion = getopt(argc, argv, "n:o:k:a:e:r:t:m:c:f:l:ipj:g:xs:")) != -1) {
+        switch (opcion) {
+            case 'n': if (!leer_numero(optarg, &config->claves)) return false; break;
+            case 'o': if (!leer_numero(optarg, &config->operaciones)) return false; break;
+            case 'r': if (!leer_numero(optarg, &config->rotaciones)) return false; break;
+            case 't': if (!leer_numero(optarg, &config->tandas)) return false; break;
+            case 'l': if (!leer_numero(optarg, &config->lote)) return false; break;
+            case 'e': if (!leer_real(optarg, &config->aciertos)) return false; break;
+            case 's': if (!leer_entero(optarg, &config->semilla)) return false; break;
+            case 'i': config->opciones.redimension_incremental = true; break;
+            case 'p': config->reservar = true; break;
+            case 'j':
+                config->cargar = true;
+                if (!leer_numero(optarg, &config->hilos_carga)) return false;
+                break;
+            case 'g': config->archivo = optarg; break;
+            case 'x': config->estadisticas = true; break;
+            case 'k':
+                if (strcmp(optarg, "secuencial") == 0) config->tipo_clave = CLAVE_SECUENCIAL;
+                else if (strcmp(optarg, "aleatoria") == 0) config->tipo_clave = CLAVE_ALEATORIA;
+                else if (strcmp(optarg, "url") == 0) config->tipo_clave = CLAVE_URL;
+                else return false;
+                break;
+            case 'a':
+                if (strcmp(optarg, "uniforme") == 0) config->acceso = ACCESO_UNIFORME;
+                else if (strcmp(optarg, "zipf") == 0) config->acceso = ACCESO_ZIPF;
+                else return false;
+                break;
+            case 'm':
+                if (strcmp(optarg, "lineal") == 0) config->opciones.motor = HASH_MOTOR_LINEAL;
+                else if (strcmp(optarg, "robin_hood") == 0) config->opciones.motor = HASH_MOTOR_ROBIN_HOOD;
+                else return false;
+                break;
+            case 'f':
+                if (strcmp(optarg, "wyhash") == 0) config->opciones.funcion = HASH_FUNCION_WYHASH;
+                else if (strcmp(optarg, "djb2") == 0) config->opciones.funcion = HASH_FUNCION_DJB2;
+                else return false;
+                break;
+            case 'c':
+                if (strcmp(optarg, "malloc") == 0) config->opciones.claves_en_arena = false;
+                else if (strcmp(optarg, "arena") == 0) config->opciones.claves_en_arena = true;
+                else return false;
+                break;
+            default:
+                return false;
+        }
+    }
+    config->largo_clave = config->tipo_clave == CLAVE_URL ? LARGO_MAX_CLAVE : LARGO_CLAVE_CORTA;
+    return config->claves > 0 && config->lote > 0;
+}
+
+int main(int argc, char *argv[]) {
+    config_t config;
+    if (!leer_config(&config, argc, argv)) {
+        uso(argv[0]);
+        return 1;
+    }
+    estado_rng = config.semilla;
+
+    char *claves = malloc(config.claves * config.largo_clave);
+    double *zipf = config.acceso == ACCESO_ZIPF ? zipf_crear(config.claves) : NULL;
+    hash_t *hash = hash_crear_opciones(NULL, &config.opciones);
+    if (!claves || !hash || (config.acceso == ACCESO_ZIPF && !zipf)) {
+        fprintf(stderr, "no hay memoria suficiente\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < config.claves; i++) escribir_clave(clave_en(claves, &config, i), config.tipo_clave, i);
+    uint64_t siguiente_id = config.claves;
+
+    printf("claves %zu, operaciones %zu, aciertos %.2f, rotaciones %zu\n\n", config.claves,
+           config.operaciones, config.aciertos, config.rotaciones);
+    printf("%-12s %10s %14s %9s %9s %9s %11s\n", "fase", "ops", "ops/seg", "p50(ns)", "p99(ns)",
+           "p999(ns)", "max(ns)");
+
+    if (config.reservar && !hash_reservar(hash, config.claves)) {
+        fprintf(stderr, "no hay memoria suficiente\n");
+        return 1;
+    }
+
+    bool ok = config.cargar ? fase_carga(hash, &config, claves) : fase_insercion(hash, &config, claves);
+    for (size_t tanda = 1; tanda <= config.tandas && ok; tanda++) {
+        if (config.tandas > 1) printf("\ntanda %zu\n", tanda);
+        ok = fase_rotacion(hash, &config, claves, &siguiente_id);
+        ok = ok && fase_busqueda(hash, &config, claves, zipf);
+    }
+    ok = ok && fase_lote(hash, &config, claves, zipf);
+    ok = ok && fase_iteracion(hash);
+    if (config.archivo) ok = ok && fase_archivo(hash, &config, claves, zipf);
+    if (config.estadisticas) {
+        printf("\nestadisticas\n");
+        hash_estadisticas_imprimir(hash, stdout);
+    }
+
+    if (!ok) fprintf(stderr, "ERROR: el hash devolvió resultados incorrectos\n");
+
+    uint64_t inicio = ahora_ns();
+    hash_destruir(hash);
+    printf("destruccion: %.3f ms\n", (double) (ahora_ns() - inicio) / 1e6);
+
+    free(zipf);
+    free(claves);
+    return !ok;
+}
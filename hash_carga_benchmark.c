@@ -0,0 +1,174 @@
+/*
+ * hash_carga_benchmark.c
+ * Memoria y velocidad de la Tabla de Hash según la carga máxima.
+ *
+ * Compilación (programa aparte, no usa main.c):
+ *
+ *     gcc -O2 -std=gnu99 -pthread -o benchmark_carga hash_carga_benchmark.c hash.c
+ *
+ * Uso:
+ *
+ *     ./benchmark_carga [-c capacidad] [-o operaciones] [-s semilla]
+ *
+ * Para cada motor y cada carga máxima crea una tabla de 'capacidad'
+ * posiciones (con la opción capacidad_inicial) y la llena justo hasta esa
+ * carga, sin que crezca. Imprime los bytes de tabla por clave y, para
+ * 'operaciones' búsquedas al azar de claves que están y que no están, los
+ * nanosegundos por búsqueda y las posiciones visitadas en promedio. Así se
+ * ve cuánta memoria se ahorra con más carga y cuánto cuesta en sondeos.
+ */
+
+#include "benchmark_comun.h"
+#include "hash.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>  // getopt
+
+#define LARGO_CLAVE 24
+// Cada posición de la tabla es un campo de 32 bytes más su byte de control.
+#define BYTES_POR_POSICION 33
+// Las claves que no están se generan a partir de este identificador.
+#define ID_FALLOS (1ULL << 40)
+
+typedef struct config {
+    size_t capacidad;
+    size_t operaciones;
+    uint64_t semilla;
+} config_t;
+
+typedef struct resultado {
+    double ns_insercion;
+    double ns_acierto;
+    double ns_fallo;
+    double sondeo_acierto;
+    double sondeo_fallo;
+} resultado_t;
+
+static const double cargas[] = { 0.5, 0.6, 0.7, 0.8, 0.85, 0.9, 0.95 };
+
+/* ******************************************************************
+ *                            MEDICIÓN
+ * *****************************************************************/
+
+/* Busca 'operaciones' claves al azar, que están si aciertos es true, y
+ * devuelve los nanosegundos por búsqueda. Las claves se escriben antes de
+ * medir; los sondeos se cuentan aparte, con hash_largo_sondeo.
+ */
+static bool buscar(const hash_t *hash, const config_t *config, const char *claves, size_t cantidad,
+                   bool aciertos, double *ns, double *sondeo) {
+    char *buscadas = malloc(config->operaciones * LARGO_CLAVE);
+    if (!buscadas) return false;
+
+    uint64_t estado = config->semilla;
+    for (size_t i = 0; i < config->operaciones; i++) {
+        size_t indice = aleatorio(&estado) % cantidad;
+        if (aciertos) memcpy(buscadas + i * LARGO_CLAVE, claves + indice * LARGO_CLAVE, LARGO_CLAVE);
+        else escribir_clave_aleatoria(buscadas + i * LARGO_CLAVE, LARGO_CLAVE, ID_FALLOS + indice);
+    }
+
+    bool ok = true;
+    uint64_t inicio = ahora_ns();
+    for (size_t i = 0; i < config->operaciones; i++) {
+        ok &= (hash_obtener(hash, buscadas + i * LARGO_CLAVE) != NULL) == aciertos;
+    }
+    *ns = (double) (ahora_ns() - inicio) / (double) config->operaciones;
+
+    size_t total = 0;
+    for (size_t i = 0; i < config->operaciones; i++) total += hash_largo_sondeo(hash, buscadas + i * LARGO_CLAVE);
+    *sondeo = (double) total / (double) config->operaciones;
+
+    free(buscadas);
+    return ok;
+}
+
+static bool medir(const config_t *config, hash_motor_t motor, double carga, const char *claves, size_t cantidad,
+                  resultado_t *resultado) {
+    hash_opciones_t opciones = { .motor = motor, .capacidad_inicial = config->capacidad, .carga_maxima = carga };
+    hash_t *hash = hash_crear_opciones(NULL, &opciones);
+    if (!hash) return false;
+
+    bool ok = true;
+    uint64_t inicio = ahora_ns();
+    for (size_t i = 0; i < cantidad && ok; i++) {
+        ok = hash_guardar(hash, claves + i * LARGO_CLAVE, (void *) (claves + i * LARGO_CLAVE));
+    }
+    resultado->ns_insercion = (double) (ahora_ns() - inicio) / (double) cantidad;
+
+    hash_estadisticas_t estadisticas;
+    hash_estadisticas(hash, &estadisticas);
+    ok = ok && estadisticas.capacidad == config->capacidad;
+    ok = ok && buscar(hash, config, claves, cantidad, true, &resultado->ns_acierto, &resultado->sondeo_acierto);
+    ok = ok && buscar(hash, config, claves, cantidad, false, &resultado->ns_fallo, &resultado->sondeo_fallo);
+
+    hash_destruir(hash);
+    return ok;
+}
+
+/* ******************************************************************
+ *                        PROGRAMA PRINCIPAL
+ * *****************************************************************/
+
+static void uso(const char *programa) {
+    fprintf(stderr, "uso: %s [-c capacidad] [-o operaciones] [-s semilla]\n", programa);
+}
+
+static bool leer_config(config_t *config, int argc, char *argv[]) {
+    config->capacidad = 1 << 20;
+    config->operaciones = 1000000;
+    config->semilla = 42;
+
+    int opcion;
+    while ((opcion = getopt(argc, argv, "c:o:s:")) != -1) {
+        switch (opcion) {
+            case 'c': if (!leer_numero(optarg, &config->capacidad)) return false; break;
+            case 'o': if (!leer_numero(optarg, &config->operaciones)) return false; break;
+            case 's': if (!leer_entero(optarg, &config->semilla)) return false; break;
+            default:
+                return false;
+        }
+    }
+    return capacidad_valida(config->capacidad) && config->operaciones > 0;
+}
+
+int main(int argc, char *argv[]) {
+    config_t config;
+    if (!leer_config(&config, argc, argv)) {
+        uso(argv[0]);
+        return 1;
+    }
+
+    size_t maximo = (size_t) ((double) config.capacidad * cargas[sizeof(cargas) / sizeof(cargas[0]) - 1]);
+    char *claves = malloc(maximo * LARGO_CLAVE);
+    if (!claves) {
+        fprintf(stderr, "no hay memoria suficiente\n");
+        return 1;
+    }
+    for (size_t i = 0; i < maximo; i++) escribir_clave_aleatoria(claves + i * LARGO_CLAVE, LARGO_CLAVE, i);
+
+    printf("capacidad %zu, operaciones %zu\n\n", config.capacidad, config.operaciones);
+    printf("%-11s %6s %10s %10s %12s %11s %12s %11s\n", "motor", "carga", "bytes/clave", "ins(ns)",
+           "acierto(ns)", "sondeo", "fallo(ns)", "sondeo");
+
+    const char *nombres[] = { "lineal", "robin_hood" };
+    hash_motor_t motores[] = { HASH_MOTOR_LINEAL, HASH_MOTOR_ROBIN_HOOD };
+    bool ok = true;
+    for (size_t m = 0; m < 2 && ok; m++) {
+        for (size_t c = 0; c < sizeof(cargas) / sizeof(cargas[0]) && ok; c++) {
+            size_t cantidad = (size_t) ((double) config.capacidad * cargas[c]);
+            resultado_t resultado = { 0 };
+            ok = medir(&config, motores[m], cargas[c], claves, cantidad, &resultado);
+            printf("%-11s %6.2f %10.1f %10.1f %12.1f %11.2f %12.1f %11.2f\n", nombres[m], cargas[c],
+                   (double) (config.capacidad * BYTES_POR_POSICION) / (double) cantidad, resultado.ns_insercion,
+                   resultado.ns_acierto, resultado.sondeo_acierto, resultado.ns_fallo, resultado.sondeo_fallo);
+        }
+    }
+    if (!ok) fprintf(stderr, "ERROR: el hash devolvió resultados incorrectos\n");
+
+    free(claves);
+    return !ok;
+}
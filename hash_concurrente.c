@@ -0,0 +1,137 @@
+#include "hash_concurrente.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRANJAS_POR_OMISION 64
+#define LARGO_LINEA_CACHE 64
+
+// Cada franja ocupa su propia línea de caché, así los hilos que usan franjas
+// distintas no se pisan al tomar los locks.
+typedef struct franja{
+  pthread_rwlock_t lock;
+  hash_t* hash;
+} __attribute__((aligned(LARGO_LINEA_CACHE))) franja_t;
+
+struct hash_concurrente{
+  franja_t* franjas;
+  size_t cantidad_franjas;
+  unsigned bits; // log2 de cantidad_franjas.
+  bool claves_propias; // Las claves no son cadenas y no tienen largo.
+};
+
+static void destruir_franjas(franja_t *franjas, size_t cantidad) {
+    for (size_t i = 0; i < cantidad; i++) {
+        pthread_rwlock_destroy(&franjas[i].lock);
+        hash_destruir(franjas[i].hash);
+    }
+    free(franjas);
+}
+
+hash_concurrente_t *hash_concurrente_crear(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones,
+                                           size_t franjas) {
+    hash_opciones_t por_omision = { .motor = HASH_MOTOR_LINEAL };
+    if (!opciones) opciones = &por_omision;
+    if (franjas == 0) franjas = FRANJAS_POR_OMISION;
+
+    hash_concurrente_t *hash = malloc(sizeof(hash_concurrente_t));
+    if (!hash) return NULL;
+
+    hash->claves_propias = opciones->tipo_clave != NULL;
+    hash->bits = 0;
+    while (((size_t) 1 << hash->bits) < franjas) hash->bits++;
+    hash->cantidad_franjas = (size_t) 1 << hash->bits;
+
+    void *lugar;
+    if (posix_memalign(&lugar, LARGO_LINEA_CACHE, hash->cantidad_franjas * sizeof(franja_t)) != 0) {
+        free(hash);
+        return NULL;
+    }
+    hash->franjas = lugar;
+
+    for (size_t i = 0; i < hash->cantidad_franjas; i++) {
+        hash->franjas[i].hash = hash_crear_opciones(destruir_dato, opciones);
+        if (!hash->franjas[i].hash || pthread_rwlock_init(&hash->franjas[i].lock, NULL) != 0) {
+            if (hash->franjas[i].hash) hash_destruir(hash->franjas[i].hash);
+            destruir_franjas(hash->franjas, i);
+            free(hash);
+            return NULL;
+        }
+    }
+    return hash;
+}
+
+// Source: https://prng.di.unimi.it/splitmix64.c
+static uint64_t mezclar(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/* La franja sale de los bits altos del hash luego de mezclarlo: con DJB2 los
+ * bits altos de claves cortas casi no cambian, y sin mezclar irían todas a
+ * la misma franja. Todas las franjas tienen las mismas opciones, así que
+ * cualquiera sirve para calcular el hash.
+ */
+static franja_t *elegir_franja(const hash_concurrente_t *hash, const char *clave) {
+    if (hash->bits == 0) return &hash->franjas[0];
+    unsigned long h = hash_calcular(hash->franjas[0].hash, clave, hash->claves_propias ? 0 : strlen(clave));
+    return &hash->franjas[mezclar(h) >> (64 - hash->bits)];
+}
+
+bool hash_concurrente_guardar(hash_concurrente_t *hash, const char *clave, void *dato) {
+    franja_t *franja = elegir_franja(hash, clave);
+    pthread_rwlock_wrlock(&franja->lock);
+    bool ok = hash_guardar(franja->hash, clave, dato);
+    pthread_rwlock_unlock(&franja->lock);
+    return ok;
+}
+
+void *hash_concurrente_borrar(hash_concurrente_t *hash, const char *clave) {
+    franja_t *franja = elegir_franja(hash, clave);
+    pthread_rwlock_wrlock(&franja->lock);
+    void *dato = hash_borrar(franja->hash, clave);
+    pthread_rwlock_unlock(&franja->lock);
+    return dato;
+}
+
+// Las búsquedas no modifican la tabla, así que alcanza con el lock de lectura.
+void *hash_concurrente_obtener(hash_concurrente_t *hash, const char *clave) {
+    franja_t *franja = elegir_franja(hash, clave);
+    pthread_rwlock_rdlock(&franja->lock);
+    void *dato = hash_obtener(franja->hash, clave);
+    pthread_rwlock_unlock(&franja->lock);
+    return dato;
+}
+
+bool hash_concurrente_pertenece(hash_concurrente_t *hash, const char *clave) {
+    franja_t *franja = elegir_franja(hash, clave);
+    pthread_rwlock_rdlock(&franja->lock);
+    bool pertenece = hash_pertenece(franja->hash, clave);
+    pthread_rwlock_unlock(&franja->lock);
+    return pertenece;
+}
+
+size_t hash_concurrente_cantidad(hash_concurrente_t *hash) {
+    size_t cantidad = 0;
+    for (size_t i = 0; i < hash->cantidad_franjas; i++) {
+        pthread_rwlock_rdlock(&hash->franjas[i].lock);
+        cantidad += hash_cantidad(hash->franjas[i].hash);
+        pthread_rwlock_unlock(&hash->franjas[i].lock);
+    }
+    return cantidad;
+}
+
+size_t hash_concurrente_cantidad_franja(hash_concurrente_t *hash, size_t franja) {
+    pthread_rwlock_rdlock(&hash->franjas[franja].lock);
+    size_t cantidad = hash_cantidad(hash->franjas[franja].hash);
+    pthread_rwlock_unlock(&hash->franjas[franja].lock);
+    return cantidad;
+}
+
+void hash_concurrente_destruir(hash_concurrente_t *hash) {
+    destruir_franjas(hash->franjas, hash->cantidad_franjas);
+    free(hash);
+}
@@ -0,0 +1,69 @@
+#ifndef HASH_CONCURRENTE_H
+#define HASH_CONCURRENTE_H
+
+#include "hash.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Tabla de hash que se puede usar desde varios hilos a la vez. Está dividida
+ * en franjas, cada una un hash con su propio lock de lectura y escritura y su
+ * propia redimensión; la franja de cada clave sale de los bits altos de su
+ * hash mezclado. Las búsquedas en una franja no se bloquean entre sí, y las
+ * operaciones sobre franjas distintas tampoco.
+ */
+struct hash_concurrente;
+typedef struct hash_concurrente hash_concurrente_t;
+
+/* Crea el hash con 'franjas' franjas (se redondea a la siguiente potencia de
+ * dos; 0 usa un valor por omisión). Las opciones son las de cada franja y
+ * pueden ser NULL para usar las de hash_crear. Con tipo_clave, las claves
+ * que reciben las demás funciones son valores de ese tipo y no cadenas.
+ */
+hash_concurrente_t *hash_concurrente_crear(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones,
+                                           size_t franjas);
+
+/* Guarda un elemento, reemplazando el dato si la clave ya estaba. De no
+ * poder guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_concurrente_guardar(hash_concurrente_t *hash, const char *clave, void *dato);
+
+/* Borra un elemento y devuelve el dato asociado, o NULL si no estaba.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_concurrente_borrar(hash_concurrente_t *hash, const char *clave);
+
+/* Obtiene el dato asociado a la clave, o NULL si no está. Si otro hilo puede
+ * borrar o reemplazar la clave, el que lo hace es responsable de no destruir
+ * el dato mientras se esté usando.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_concurrente_obtener(hash_concurrente_t *hash, const char *clave);
+
+/* Determina si la clave pertenece al hash.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_concurrente_pertenece(hash_concurrente_t *hash, const char *clave);
+
+/* Devuelve la cantidad de elementos. Con otros hilos modificando el hash el
+ * resultado es aproximado, porque las franjas se cuentan de a una.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_concurrente_cantidad(hash_concurrente_t *hash);
+
+/* Devuelve la cantidad de elementos de la franja número 'franja', para ver
+ * cómo se reparten las claves entre los locks.
+ * Pre: La estructura hash fue inicializada y 'franja' es menor que la
+ * cantidad de franjas
+ */
+size_t hash_concurrente_cantidad_franja(hash_concurrente_t *hash, size_t franja);
+
+/* Destruye la estructura, llamando a la función destruir para cada dato.
+ * Ningún otro hilo puede estar usando el hash.
+ * Pre: La estructura hash fue inicializada
+ * Post: La estructura hash fue destruida
+ */
+void hash_concurrente_destruir(hash_concurrente_t *hash);
+
+#endif  // HASH_CONCURRENTE_H
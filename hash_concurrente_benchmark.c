@@ -0,0 +1,278 @@
+/*
+ * hash_concurrente_benchmark.c
+ * Escalabilidad de la Tabla de Hash concurrente con varios hilos.
+ *
+ * Compilación (programa aparte, no usa main.c):
+ *
+ *     gcc -O2 -std=gnu99 -pthread -o benchmark_concurrente hash_concurrente_benchmark.c \
+ *         hash_concurrente.c hash_rcu.c hash.c
+ *
+ * Uso:
+ *
+ *     ./benchmark_concurrente [-n claves] [-o operaciones] [-h hilos]
+ *                             [-e lecturas] [-f franjas] [-s semilla]
+ *
+ * Guarda 'claves' claves y después cada hilo hace 'operaciones' operaciones
+ * sobre claves al azar: una fracción 'lecturas' son búsquedas y el resto
+ * reemplaza el dato de la clave. Repite la medición con 1, 2, 4, ... hasta
+ * 'hilos' hilos, para un hash común protegido por un único mutex, para el
+ * hash concurrente con 'franjas' franjas y para el hash con lecturas sin
+ * bloqueo, e imprime operaciones por segundo y cuánto rinde respecto de un
+ * hilo. Con -e 1 se mide cómo escalan solo las lecturas.
+ */
+
+#include "benchmark_comun.h"
+#include "hash.h"
+#include "hash_concurrente.h"
+#include "hash_rcu.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>  // getopt
+
+#define LARGO_CLAVE 24
+
+typedef struct config {
+    size_t claves;
+    size_t operaciones;
+    size_t hilos;
+    double lecturas;
+    size_t franjas;
+    uint64_t semilla;
+} config_t;
+
+// Las formas de compartir el hash entre hilos se usan a través de esta interfaz.
+typedef struct variante {
+    const char *nombre;
+    void *(*crear)(const config_t *config);
+    bool (*guardar)(void *tabla, const char *clave, void *dato);
+    void *(*obtener)(void *tabla, const char *clave);
+    void (*destruir)(void *tabla);
+} variante_t;
+
+typedef struct hilo {
+    const variante_t *variante;
+    void *tabla;
+    const config_t *config;
+    const char *claves;
+    uint64_t semilla;
+    bool ok;
+} hilo_t;
+
+/* ******************************************************************
+ *                            VARIANTES
+ * *****************************************************************/
+
+typedef struct hash_global {
+    pthread_mutex_t mutex;
+    hash_t *hash;
+} hash_global_t;
+
+static void *global_crear(const config_t *config) {
+    (void) config;
+    hash_global_t *global = malloc(sizeof(hash_global_t));
+    if (!global) return NULL;
+    global->hash = hash_crear(NULL);
+    if (!global->hash) {
+        free(global);
+        return NULL;
+    }
+    pthread_mutex_init(&global->mutex, NULL);
+    return global;
+}
+
+static bool global_guardar(void *tabla, const char *clave, void *dato) {
+    hash_global_t *global = tabla;
+    pthread_mutex_lock(&global->mutex);
+    bool ok = hash_guardar(global->hash, clave, dato);
+    pthread_mutex_unlock(&global->mutex);
+    return ok;
+}
+
+static void *global_obtener(void *tabla, const char *clave) {
+    hash_global_t *global = tabla;
+    pthread_mutex_lock(&global->mutex);
+    void *dato = hash_obtener(global->hash, clave);
+    pthread_mutex_unlock(&global->mutex);
+    return dato;
+}
+
+static void global_destruir(void *tabla) {
+    hash_global_t *global = tabla;
+    pthread_mutex_destroy(&global->mutex);
+    hash_destruir(global->hash);
+    free(global);
+}
+
+static void *franjas_crear(const config_t *config) {
+    return hash_concurrente_crear(NULL, NULL, config->franjas);
+}
+
+static bool franjas_guardar(void *tabla, const char *clave, void *dato) {
+    return hash_concurrente_guardar(tabla, clave, dato);
+}
+
+static void *franjas_obtener(void *tabla, const char *clave) {
+    return hash_concurrente_obtener(tabla, clave);
+}
+
+static void franjas_destruir(void *tabla) {
+    hash_concurrente_destruir(tabla);
+}
+
+static void *rcu_crear(const config_t *config) {
+    (void) config;
+    return hash_rcu_crear(NULL);
+}
+
+static bool rcu_guardar(void *tabla, const char *clave, void *dato) {
+    return hash_rcu_guardar(tabla, clave, dato);
+}
+
+static void *rcu_obtener(void *tabla, const char *clave) {
+    return hash_rcu_obtener(tabla, clave);
+}
+
+static void rcu_destruir(void *tabla) {
+    hash_rcu_destruir(tabla);
+}
+
+static const variante_t variantes[] = {
+    { "mutex global", global_crear, global_guardar, global_obtener, global_destruir },
+    { "franjas", franjas_crear, franjas_guardar, franjas_obtener, franjas_destruir },
+    { "rcu", rcu_crear, rcu_guardar, rcu_obtener, rcu_destruir },
+};
+
+/* ******************************************************************
+ *                            MEDICIÓN
+ * *****************************************************************/
+
+/* Las claves guardan como dato su propio puntero, así cada búsqueda puede
+ * comprobar el resultado aunque otro hilo haya reemplazado el dato.
+ */
+static void *trabajar(void *extra) {
+    hilo_t *hilo = extra;
+    const config_t *config = hilo->config;
+    uint64_t limite_lecturas = (uint64_t) (config->lecturas * (double) UINT32_MAX);
+    hilo->ok = true;
+
+    for (size_t i = 0; i < config->operaciones && hilo->ok; i++) {
+        uint64_t azar = aleatorio(&hilo->semilla);
+        const char *clave = hilo->claves + (azar >> 32) % config->claves * LARGO_CLAVE;
+        if ((azar & UINT32_MAX) < limite_lecturas) {
+            hilo->ok = hilo->variante->obtener(hilo->tabla, clave) == clave;
+        } else {
+            hilo->ok = hilo->variante->guardar(hilo->tabla, clave, (void *) clave);
+        }
+    }
+    return NULL;
+}
+
+// Devuelve las operaciones por segundo con 'hilos' hilos, o 0 si algo falló.
+static double medir(const variante_t *variante, const config_t *config, const char *claves, size_t hilos) {
+    void *tabla = variante->crear(config);
+    if (!tabla) return 0;
+
+    bool ok = true;
+    for (size_t i = 0; i < config->claves && ok; i++) {
+        ok = variante->guardar(tabla, claves + i * LARGO_CLAVE, (void *) (claves + i * LARGO_CLAVE));
+    }
+
+    pthread_t *ids = malloc(hilos * sizeof(pthread_t));
+    hilo_t *datos = malloc(hilos * sizeof(hilo_t));
+    if (!ids || !datos) ok = false;
+
+    uint64_t inicio = ahora_ns();
+    size_t creados = 0;
+    for (; creados < hilos && ok; creados++) {
+        datos[creados] = (hilo_t) { .variante = variante, .tabla = tabla, .config = config, .claves = claves,
+                                    .semilla = mezclar(config->semilla + creados) };
+        ok = pthread_create(&ids[creados], NULL, trabajar, &datos[creados]) == 0;
+        if (!ok) break;
+    }
+    for (size_t i = 0; i < creados; i++) {
+        pthread_join(ids[i], NULL);
+        ok = ok && datos[i].ok;
+    }
+    uint64_t total_ns = ahora_ns() - inicio;
+
+    free(ids);
+    free(datos);
+    variante->destruir(tabla);
+    if (!ok) return 0;
+    return (double) (hilos * config->operaciones) / ((double) total_ns / 1e9);
+}
+
+/* ******************************************************************
+ *                        PROGRAMA PRINCIPAL
+ * *****************************************************************/
+
+static void uso(const char *programa) {
+    fprintf(stderr, "uso: %s [-n claves] [-o operaciones] [-h hilos]\n"
+                    "          [-e lecturas] [-f franjas] [-s semilla]\n", programa);
+}
+
+static bool leer_config(config_t *config, int argc, char *argv[]) {
+    config->claves = 1000000;
+    config->operaciones = 1000000;
+    config->hilos = 32;
+    config->lecturas = 0.9;
+    config->franjas = 64;
+    config->semilla = 42;
+
+    int opcion;
+    while ((opcion = getopt(argc, argv, "n:o:h:e:f:s:")) != -1) {
+        switch (opcion) {
+            case 'n': if (!leer_numero(optarg, &config->claves)) return false; break;
+            case 'o': if (!leer_numero(optarg, &config->operaciones)) return false; break;
+            case 'h': if (!leer_numero(optarg, &config->hilos)) return false; break;
+            case 'e': if (!leer_real(optarg, &config->lecturas)) return false; break;
+            case 'f': if (!leer_numero(optarg, &config->franjas)) return false; break;
+            case 's': if (!leer_entero(optarg, &config->semilla)) return false; break;
+            default:
+                return false;
+        }
+    }
+    return config->claves > 0 && config->hilos > 0;
+}
+
+int main(int argc, char *argv[]) {
+    config_t config;
+    if (!leer_config(&config, argc, argv)) {
+        uso(argv[0]);
+        return 1;
+    }
+
+    char *claves = malloc(config.claves * LARGO_CLAVE);
+    if (!claves) {
+        fprintf(stderr, "no hay memoria suficiente\n");
+        return 1;
+    }
+    for (size_t i = 0; i < config.claves; i++) {
+        escribir_clave_aleatoria(claves + i * LARGO_CLAVE, LARGO_CLAVE, i);
+    }
+
+    printf("claves %zu, operaciones por hilo %zu, lecturas %.2f, franjas %zu, procesadores %ld\n\n",
+           config.claves, config.operaciones, config.lecturas, config.franjas, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-14s %6s %14s %10s\n", "variante", "hilos", "ops/seg", "escala");
+
+    bool ok = true;
+    for (size_t v = 0; v < sizeof(variantes) / sizeof(variantes[0]) && ok; v++) {
+        double base = 0;
+        for (size_t hilos = 1; hilos <= config.hilos && ok; hilos *= 2) {
+            double ops = medir(&variantes[v], &config, claves, hilos);
+            ok = ops > 0;
+            if (hilos == 1) base = ops;
+            printf("%-14s %6zu %14.0f %9.2fx\n", variantes[v].nombre, hilos, ops, ok ? ops / base : 0);
+        }
+    }
+    if (!ok) fprintf(stderr, "ERROR: el hash devolvió resultados incorrectos\n");
+
+    free(claves);
+    return !ok;
+}
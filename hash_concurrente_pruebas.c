@@ -0,0 +1,184 @@
+/*
+ * hash_concurrente_pruebas.c
+ * Pruebas para la Tabla de Hash concurrente
+ */
+
+#include "hash_concurrente.h"
+#include "testing.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HILOS_PRUEBA 4
+#define CLAVES_POR_HILO 5000
+#define LARGO_CLAVE_PRUEBA 24
+
+
+/* ******************************************************************
+ *                        PRUEBAS UNITARIAS
+ * *****************************************************************/
+
+static void prueba_hash_concurrente_basico()
+{
+    hash_concurrente_t* hash = hash_concurrente_crear(NULL, NULL, 8);
+
+    char *clave1 = "perro", *valor1 = "guau";
+    char *clave2 = "gato", *valor2 = "miau";
+
+    print_test("Prueba hash concurrente crear", hash);
+    print_test("Prueba hash concurrente guardar clave1", hash_concurrente_guardar(hash, clave1, valor1));
+    print_test("Prueba hash concurrente guardar clave2", hash_concurrente_guardar(hash, clave2, valor2));
+    print_test("Prueba hash concurrente la cantidad de elementos es 2", hash_concurrente_cantidad(hash) == 2);
+    print_test("Prueba hash concurrente obtener clave1 es valor1", hash_concurrente_obtener(hash, clave1) == valor1);
+    print_test("Prueba hash concurrente pertenece clave2", hash_concurrente_pertenece(hash, clave2));
+    print_test("Prueba hash concurrente borrar clave1 es valor1", hash_concurrente_borrar(hash, clave1) == valor1);
+    print_test("Prueba hash concurrente clave1 no pertenece", !hash_concurrente_pertenece(hash, clave1));
+    print_test("Prueba hash concurrente la cantidad de elementos es 1", hash_concurrente_cantidad(hash) == 1);
+
+    hash_concurrente_destruir(hash);
+}
+
+static unsigned long hashear_entero(const void* clave)
+{
+    return (unsigned long) *(const uint64_t*) clave;
+}
+
+static bool enteros_iguales(const void* a, const void* b)
+{
+    return *(const uint64_t*) a == *(const uint64_t*) b;
+}
+
+/* Con claves propias la franja se elige sin leer la clave como cadena: cada
+ * entero ocupa justo su memoria y no tiene ningún '\0' (ASan avisa si no) */
+static void prueba_hash_concurrente_claves_propias()
+{
+    hash_tipo_clave_t tipo = { hashear_entero, enteros_iguales, NULL, NULL };
+    hash_opciones_t opciones = { .tipo_clave = &tipo };
+    hash_concurrente_t* hash = hash_concurrente_crear(NULL, &opciones, 8);
+
+    uint64_t* claves[16] = { NULL };
+    bool ok = hash != NULL;
+    for (size_t i = 0; i < 16 && ok; i++) {
+        claves[i] = malloc(sizeof(uint64_t));
+        *claves[i] = 0x0101010101010101ULL * (i + 1);
+        ok = hash_concurrente_guardar(hash, (const char*) claves[i], claves[i]);
+    }
+    for (size_t i = 0; i < 16 && ok; i++) {
+        uint64_t buscada = 0x0101010101010101ULL * (i + 1);
+        uint64_t* copia = malloc(sizeof(uint64_t));
+        *copia = buscada;
+        ok = hash_concurrente_obtener(hash, (const char*) copia) == claves[i];
+        free(copia);
+    }
+    print_test("Prueba hash concurrente con claves propias", ok && hash_concurrente_cantidad(hash) == 16);
+
+    hash_concurrente_destruir(hash);
+    for (size_t i = 0; i < 16; i++) free(claves[i]);
+}
+
+typedef struct hilo_prueba {
+    hash_concurrente_t* hash;
+    char (*claves)[LARGO_CLAVE_PRUEBA];
+    size_t numero;
+    bool ok;
+} hilo_prueba_t;
+
+/* Cada hilo guarda sus claves, busca las de todos y borra la mitad de las
+ * suyas. Las claves de los demás pueden estar o no, pero si están tienen
+ * que tener su dato.
+ */
+static void *trabajar(void *extra)
+{
+    hilo_prueba_t* hilo = extra;
+    size_t inicio = hilo->numero * CLAVES_POR_HILO;
+    size_t total = HILOS_PRUEBA * CLAVES_POR_HILO;
+    hilo->ok = true;
+
+    for (size_t i = inicio; i < inicio + CLAVES_POR_HILO && hilo->ok; i++) {
+        hilo->ok = hash_concurrente_guardar(hilo->hash, hilo->claves[i], hilo->claves[i]);
+        char *otra = hilo->claves[(i * 7) % total];
+        void *dato = hash_concurrente_obtener(hilo->hash, otra);
+        hilo->ok = hilo->ok && (!dato || dato == otra);
+    }
+    for (size_t i = inicio; i < inicio + CLAVES_POR_HILO && hilo->ok; i += 2) {
+        hilo->ok = hash_concurrente_borrar(hilo->hash, hilo->claves[i]) == hilo->claves[i];
+    }
+    return NULL;
+}
+
+static void prueba_hash_concurrente_hilos()
+{
+    hash_concurrente_t* hash = hash_concurrente_crear(NULL, NULL, 0);
+    size_t total = HILOS_PRUEBA * CLAVES_POR_HILO;
+    char (*claves)[LARGO_CLAVE_PRUEBA] = crear_claves_prueba(total, LARGO_CLAVE_PRUEBA);
+
+    pthread_t hilos[HILOS_PRUEBA];
+    hilo_prueba_t datos[HILOS_PRUEBA];
+    for (size_t i = 0; i < HILOS_PRUEBA; i++) {
+        datos[i] = (hilo_prueba_t) { .hash = hash, .claves = claves, .numero = i };
+        pthread_create(&hilos[i], NULL, trabajar, &datos[i]);
+    }
+    bool ok = true;
+    for (size_t i = 0; i < HILOS_PRUEBA; i++) {
+        pthread_join(hilos[i], NULL);
+        ok = ok && datos[i].ok;
+    }
+    print_test("Prueba hash concurrente varios hilos guardan, buscan y borran", ok);
+
+    for (size_t i = 0; i < total && ok; i++) {
+        ok = hash_concurrente_obtener(hash, claves[i]) == (i % 2 ? claves[i] : NULL);
+    }
+    print_test("Prueba hash concurrente quedan las claves que no se borraron", ok);
+    print_test("Prueba hash concurrente la cantidad de elementos es correcta",
+               hash_concurrente_cantidad(hash) == total / 2);
+
+    free(claves);
+    hash_concurrente_destruir(hash);
+}
+
+/* DJB2 deja casi iguales los bits altos de claves cortas parecidas; la
+ * franja tiene que salir igual de todo el hash, así cada una recibe una
+ * parte pareja de las claves */
+#define FRANJAS_PRUEBA 8
+#define CLAVES_FRANJAS 100000
+
+static void prueba_hash_concurrente_franjas_djb2()
+{
+    hash_opciones_t opciones = { .funcion = HASH_FUNCION_DJB2 };
+    hash_concurrente_t* hash = hash_concurrente_crear(NULL, &opciones, FRANJAS_PRUEBA);
+    char clave[LARGO_CLAVE_PRUEBA];
+
+    bool ok = true;
+    for (int i = 0; i < CLAVES_FRANJAS && ok; i++) {
+        snprintf(clave, sizeof(clave), "%08d", i);
+        ok = hash_concurrente_guardar(hash, clave, NULL);
+    }
+    print_test("Prueba hash concurrente franjas djb2 guardar claves cortas", ok);
+
+    /* Cada franja queda a menos de un 10% del promedio */
+    size_t promedio = CLAVES_FRANJAS / FRANJAS_PRUEBA;
+    for (size_t i = 0; i < FRANJAS_PRUEBA && ok; i++) {
+        size_t cantidad = hash_concurrente_cantidad_franja(hash, i);
+        ok = cantidad > promedio - promedio / 10 && cantidad < promedio + promedio / 10;
+    }
+    print_test("Prueba hash concurrente franjas djb2 las claves se reparten", ok);
+
+    hash_concurrente_destruir(hash);
+}
+
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+
+void pruebas_hash_concurrente()
+{
+    /* Ejecuta todas las pruebas unitarias. */
+    prueba_hash_concurrente_basico();
+    prueba_hash_concurrente_claves_propias();
+    prueba_hash_concurrente_hilos();
+    prueba_hash_concurrente_franjas_djb2();
+}
@@ -0,0 +1,381 @@
+#include "hash_cuco.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POSICIONES_BALDE 2
+#define BALDES_INICIALES 16
+#define FACTOR_ACHICAR 4
+// Claves que se guardan aparte cuando no se encuentra lugar en sus baldes.
+// Al llenarse el escondite la tabla se agranda.
+#define TAMANIO_ESCONDITE 8
+// Baldes que visita como mucho la búsqueda de un camino de desalojos.
+#define LIMITE_BUSQUEDA 256
+#define SIN_PADRE (-1)
+#define LARGO_LINEA_CACHE 64
+
+// La tabla crece al 85% de carga. El límite teórico con dos baldes de 2
+// posiciones ronda el 89.7%, pero cerca de él los caminos de desalojos se
+// alargan y el escondite se llena.
+#define CARGA_NUMERADOR 17
+#define CARGA_DENOMINADOR 20
+
+// Las claves de hasta LARGO_CLAVE_CORTA bytes se guardan dentro de la posición.
+// El último byte indica cuánto lugar sobra (y hace de '\0' si no sobra nada),
+// vale CLAVE_LARGA si la clave está afuera y se guardan su puntero y largo, o
+// POSICION_LIBRE si la posición no tiene clave.
+#define LARGO_CLAVE_CORTA 15
+#define CLAVE_LARGA 0xFF
+#define POSICION_LIBRE 0xFE
+
+typedef union clave{
+  struct {
+    char* puntero;
+    uint32_t largo;
+  } larga;
+  char corta[LARGO_CLAVE_CORTA + 1];
+} clave_t;
+
+// 32 bytes, como campo_t en hash.c. Se guarda el hash entero de la clave,
+// así se descartan las que no coinciden y se calcula el balde alternativo
+// sin leer las claves largas.
+typedef struct posicion{
+  clave_t clave;
+  void* dato;
+  uint64_t hash;
+} posicion_t;
+
+// 64 bytes: cada balde ocupa exactamente una línea de caché.
+typedef struct balde{
+  posicion_t posiciones[POSICIONES_BALDE];
+} balde_t;
+
+struct hash_cuco{
+  size_t cantidad_baldes;
+  size_t cantidad;
+  size_t maximo; // Cantidad a partir de la cual se agranda la tabla.
+  balde_t* baldes;
+  size_t en_escondite;
+  posicion_t escondite[TAMANIO_ESCONDITE];
+  hash_destruir_dato_t destruir_dato;
+};
+
+// Nodo de la búsqueda en anchura: la clave de la posición 'posicion' del
+// balde del padre se puede mover a este balde.
+typedef struct nodo{
+  size_t balde;
+  int padre;
+  int posicion;
+} nodo_t;
+
+/* Los dos baldes de una clave salen de mitades distintas de su hash. Si
+ * coinciden se usa el vecino, así cada clave siempre tiene dos opciones.
+ */
+static size_t primer_balde(const hash_cuco_t *hash, uint64_t h) {
+    return h & (hash->cantidad_baldes - 1);
+}
+
+static size_t segundo_balde(const hash_cuco_t *hash, uint64_t h) {
+    size_t balde = (h >> 32 | h << 32) & (hash->cantidad_baldes - 1);
+    return balde == primer_balde(hash, h) ? balde ^ 1 : balde;
+}
+
+static size_t balde_alternativo(const hash_cuco_t *hash, size_t balde, uint64_t h) {
+    size_t primero = primer_balde(hash, h);
+    return balde == primero ? segundo_balde(hash, h) : primero;
+}
+
+static bool esta_libre(const posicion_t *posicion) {
+    return (unsigned char) posicion->clave.corta[LARGO_CLAVE_CORTA] == POSICION_LIBRE;
+}
+
+static void liberar_posicion(posicion_t *posicion) {
+    posicion->clave.corta[LARGO_CLAVE_CORTA] = (char) POSICION_LIBRE;
+}
+
+static bool clave_corta(const posicion_t *posicion) {
+    return (unsigned char) posicion->clave.corta[LARGO_CLAVE_CORTA] != CLAVE_LARGA;
+}
+
+static const char *ver_clave(const posicion_t *posicion) {
+    return clave_corta(posicion) ? posicion->clave.corta : posicion->clave.larga.puntero;
+}
+
+static size_t largo_clave(const posicion_t *posicion) {
+    if (clave_corta(posicion)) return LARGO_CLAVE_CORTA - (unsigned char) posicion->clave.corta[LARGO_CLAVE_CORTA];
+    return posicion->clave.larga.largo;
+}
+
+// Copia la clave dentro de la posición si es corta, o fuera de la tabla si no.
+static bool guardar_clave(posicion_t *posicion, const char *clave, size_t largo) {
+    if (largo <= LARGO_CLAVE_CORTA) {
+        memcpy(posicion->clave.corta, clave, largo);
+        posicion->clave.corta[largo] = '\0';
+        posicion->clave.corta[LARGO_CLAVE_CORTA] = (char) (LARGO_CLAVE_CORTA - largo);
+        return true;
+    }
+    if (largo > UINT32_MAX) return false;
+    posicion->clave.larga.puntero = malloc(largo + 1);
+    if (!posicion->clave.larga.puntero) return false;
+    memcpy(posicion->clave.larga.puntero, clave, largo + 1);
+    posicion->clave.larga.largo = (uint32_t) largo;
+    posicion->clave.corta[LARGO_CLAVE_CORTA] = (char) CLAVE_LARGA;
+    return true;
+}
+
+static void soltar_clave(posicion_t *posicion) {
+    if (!clave_corta(posicion)) free(posicion->clave.larga.puntero);
+}
+
+static bool crear_tabla(hash_cuco_t *hash, size_t cantidad_baldes) {
+    void *baldes;
+    if (posix_memalign(&baldes, sizeof(balde_t), cantidad_baldes * sizeof(balde_t)) != 0) return false;
+    hash->baldes = baldes;
+    for (size_t i = 0; i < cantidad_baldes; i++) {
+        for (size_t j = 0; j < POSICIONES_BALDE; j++) liberar_posicion(&hash->baldes[i].posiciones[j]);
+    }
+    hash->cantidad_baldes = cantidad_baldes;
+    hash->maximo = cantidad_baldes * POSICIONES_BALDE * CARGA_NUMERADOR / CARGA_DENOMINADOR;
+    hash->en_escondite = 0;
+    return true;
+}
+
+// Devuelve la primera posición libre del balde, o POSICIONES_BALDE si está lleno.
+static int posicion_libre(const balde_t *balde) {
+    int posicion = 0;
+    while (posicion < POSICIONES_BALDE && !esta_libre(&balde->posiciones[posicion])) posicion++;
+    return posicion;
+}
+
+static bool en_camino(const nodo_t *nodos, int nodo, size_t balde) {
+    for (; nodo != SIN_PADRE; nodo = nodos[nodo].padre) {
+        if (nodos[nodo].balde == balde) return true;
+    }
+    return false;
+}
+
+/* Mueve cada clave del camino que termina en el nodo a su balde
+ * alternativo, empezando por la que va a la posición libre. Devuelve el balde
+ * de la raíz y deja en libre la posición que quedó vacía en él.
+ */
+static balde_t *desalojar(hash_cuco_t *hash, const nodo_t *nodos, int nodo, int *libre) {
+    while (nodos[nodo].padre != SIN_PADRE) {
+        balde_t *destino = &hash->baldes[nodos[nodo].balde];
+        balde_t *origen = &hash->baldes[nodos[nodos[nodo].padre].balde];
+        int posicion = nodos[nodo].posicion;
+        destino->posiciones[*libre] = origen->posiciones[posicion];
+        liberar_posicion(&origen->posiciones[posicion]);
+        *libre = posicion;
+        nodo = nodos[nodo].padre;
+    }
+    return &hash->baldes[nodos[nodo].balde];
+}
+
+/* Ubica una clave que no está en el hash. Busca en anchura, desde sus dos
+ * baldes, el balde con lugar más cercano al que se llega moviendo claves a
+ * su balde alternativo; un balde no se repite en un mismo camino, así cada
+ * clave se mueve una sola vez. Si no lo hay, la clave va al escondite.
+ * Devuelve false si el escondite también está lleno.
+ */
+static bool colocar(hash_cuco_t *hash, const posicion_t *nueva) {
+    nodo_t nodos[LIMITE_BUSQUEDA];
+    int cantidad = 0;
+    nodos[cantidad++] = (nodo_t) { .balde = primer_balde(hash, nueva->hash), .padre = SIN_PADRE };
+    nodos[cantidad++] = (nodo_t) { .balde = segundo_balde(hash, nueva->hash), .padre = SIN_PADRE };
+
+    for (int i = 0; i < cantidad; i++) {
+        balde_t *balde = &hash->baldes[nodos[i].balde];
+        int libre = posicion_libre(balde);
+        if (libre != POSICIONES_BALDE) {
+            balde = desalojar(hash, nodos, i, &libre);
+            balde->posiciones[libre] = *nueva;
+            return true;
+        }
+        for (int j = 0; j < POSICIONES_BALDE && cantidad < LIMITE_BUSQUEDA; j++) {
+            size_t alternativo = balde_alternativo(hash, nodos[i].balde, balde->posiciones[j].hash);
+            if (en_camino(nodos, i, alternativo)) continue;
+            nodos[cantidad++] = (nodo_t) { .balde = alternativo, .padre = i, .posicion = j };
+        }
+    }
+
+    if (hash->en_escondite == TAMANIO_ESCONDITE) return false;
+    hash->escondite[hash->en_escondite++] = *nueva;
+    return true;
+}
+
+/* Pasa todas las claves a una tabla nueva. Si alguna no entra, vuelve a la
+ * tabla anterior y devuelve false.
+ */
+static bool redimensionar(hash_cuco_t *hash, size_t cantidad_baldes) {
+    hash_cuco_t viejo = *hash;
+    if (!crear_tabla(hash, cantidad_baldes)) return false;
+
+    bool ok = true;
+    for (size_t i = 0; i < viejo.cantidad_baldes && ok; i++) {
+        for (size_t j = 0; j < POSICIONES_BALDE && ok; j++) {
+            if (!esta_libre(&viejo.baldes[i].posiciones[j])) ok = colocar(hash, &viejo.baldes[i].posiciones[j]);
+        }
+    }
+    for (size_t i = 0; i < viejo.en_escondite && ok; i++) ok = colocar(hash, &viejo.escondite[i]);
+
+    if (!ok) {
+        free(hash->baldes);
+        *hash = viejo;
+        return false;
+    }
+    free(viejo.baldes);
+    return true;
+}
+
+// Líneas de caché que ocupan 'largo' bytes a partir de inicio.
+static size_t lineas_de(const void *inicio, size_t largo) {
+    uintptr_t direccion = (uintptr_t) inicio;
+    return (direccion + largo - 1) / LARGO_LINEA_CACHE - direccion / LARGO_LINEA_CACHE + 1;
+}
+
+/* Compara la clave de la posición. Las claves cortas se comparan dentro del
+ * balde; las largas leen además su copia, que se suma a *lineas si no es NULL.
+ */
+static bool coincide(const posicion_t *posicion, const char *clave, size_t largo, uint64_t h, size_t *lineas) {
+    if (posicion->hash != h || esta_libre(posicion) || largo_clave(posicion) != largo) return false;
+    if (lineas && !clave_corta(posicion)) *lineas += lineas_de(posicion->clave.larga.puntero, largo + 1);
+    return memcmp(ver_clave(posicion), clave, largo) == 0;
+}
+
+/* Devuelve la posición que guarda la clave, o NULL si no está. Si
+ * escondida no es NULL deja ahí el índice de la clave en el escondite,
+ * o TAMANIO_ESCONDITE si está en un balde. Los dos baldes se piden a la vez,
+ * así las dos líneas de caché se leen en paralelo. Si lineas no es NULL
+ * suma ahí las líneas de caché leídas.
+ */
+static posicion_t *buscar(const hash_cuco_t *hash, const char *clave, size_t largo, uint64_t h,
+                          size_t *escondida, size_t *lineas) {
+    if (escondida) *escondida = TAMANIO_ESCONDITE;
+    balde_t *baldes[] = { &hash->baldes[primer_balde(hash, h)], &hash->baldes[segundo_balde(hash, h)] };
+    __builtin_prefetch(baldes[1]);
+    if (lineas) *lineas += 2;
+
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < POSICIONES_BALDE; j++) {
+            if (coincide(&baldes[i]->posiciones[j], clave, largo, h, lineas)) return &baldes[i]->posiciones[j];
+        }
+    }
+    size_t i = 0;
+    while (i < hash->en_escondite && !coincide(&hash->escondite[i], clave, largo, h, lineas)) i++;
+    if (lineas && hash->en_escondite) {
+        *lineas += lineas_de(hash->escondite, (i < hash->en_escondite ? i + 1 : i) * sizeof(posicion_t));
+    }
+    if (i == hash->en_escondite) return NULL;
+    if (escondida) *escondida = i;
+    return (posicion_t *) &hash->escondite[i];
+}
+
+hash_cuco_t *hash_cuco_crear(hash_destruir_dato_t destruir_dato) {
+    hash_cuco_t *hash = malloc(sizeof(hash_cuco_t));
+    if (!hash) return NULL;
+    if (!crear_tabla(hash, BALDES_INICIALES)) {
+        free(hash);
+        return NULL;
+    }
+    hash->cantidad = 0;
+    hash->destruir_dato = destruir_dato;
+    return hash;
+}
+
+bool hash_cuco_guardar(hash_cuco_t *hash, const char *clave, void *dato) {
+    size_t largo = strlen(clave);
+    uint64_t h = hash_wyhash(clave, largo);
+    posicion_t *encontrada = buscar(hash, clave, largo, h, NULL, NULL);
+    if (encontrada) {
+        if (hash->destruir_dato) hash->destruir_dato(encontrada->dato);
+        encontrada->dato = dato;
+        return true;
+    }
+
+    if (hash->cantidad >= hash->maximo && !redimensionar(hash, hash->cantidad_baldes * 2)) return false;
+    posicion_t nueva = { .dato = dato, .hash = h };
+    if (!guardar_clave(&nueva, clave, largo)) return false;
+
+    // Con el escondite lleno se agranda la tabla antes de la carga máxima.
+    if (!colocar(hash, &nueva) && !(redimensionar(hash, hash->cantidad_baldes * 2) && colocar(hash, &nueva))) {
+        soltar_clave(&nueva);
+        return false;
+    }
+    hash->cantidad++;
+    return true;
+}
+
+void *hash_cuco_borrar(hash_cuco_t *hash, const char *clave) {
+    size_t largo = strlen(clave);
+    uint64_t h = hash_wyhash(clave, largo);
+    size_t i;
+    posicion_t *encontrada = buscar(hash, clave, largo, h, &i, NULL);
+    if (!encontrada) return NULL;
+
+    void *dato = encontrada->dato;
+    soltar_clave(encontrada);
+    if (i < TAMANIO_ESCONDITE) hash->escondite[i] = hash->escondite[--hash->en_escondite];
+    else liberar_posicion(encontrada);
+    hash->cantidad--;
+
+    // Si no hay memoria para achicar sigue usando la tabla actual.
+    if (hash->cantidad_baldes > BALDES_INICIALES && hash->cantidad * FACTOR_ACHICAR < hash->maximo) {
+        redimensionar(hash, hash->cantidad_baldes / 2);
+    }
+    return dato;
+}
+
+void *hash_cuco_obtener(const hash_cuco_t *hash, const char *clave) {
+    size_t largo = strlen(clave);
+    posicion_t *encontrada = buscar(hash, clave, largo, hash_wyhash(clave, largo), NULL, NULL);
+    return encontrada ? encontrada->dato : NULL;
+}
+
+bool hash_cuco_pertenece(const hash_cuco_t *hash, const char *clave) {
+    size_t largo = strlen(clave);
+    return buscar(hash, clave, largo, hash_wyhash(clave, largo), NULL, NULL) != NULL;
+}
+
+size_t hash_cuco_cantidad(const hash_cuco_t *hash) {
+    return hash->cantidad;
+}
+
+size_t hash_cuco_capacidad(const hash_cuco_t *hash) {
+    return hash->cantidad_baldes * POSICIONES_BALDE;
+}
+
+size_t hash_cuco_lineas_leidas(const hash_cuco_t *hash, const char *clave) {
+    size_t largo = strlen(clave);
+    size_t lineas = 0;
+    buscar(hash, clave, largo, hash_wyhash(clave, largo), NULL, &lineas);
+    return lineas;
+}
+
+void hash_cuco_recorrer(const hash_cuco_t *hash, hash_cuco_visitar_t visitar, void *extra) {
+    for (size_t i = 0; i < hash->cantidad_baldes; i++) {
+        for (size_t j = 0; j < POSICIONES_BALDE; j++) {
+            const posicion_t *posicion = &hash->baldes[i].posiciones[j];
+            if (!esta_libre(posicion) && !visitar(ver_clave(posicion), posicion->dato, extra)) return;
+        }
+    }
+    for (size_t i = 0; i < hash->en_escondite; i++) {
+        if (!visitar(ver_clave(&hash->escondite[i]), hash->escondite[i].dato, extra)) return;
+    }
+}
+
+static void destruir_posicion(hash_cuco_t *hash, posicion_t *posicion) {
+    if (hash->destruir_dato) hash->destruir_dato(posicion->dato);
+    soltar_clave(posicion);
+}
+
+void hash_cuco_destruir(hash_cuco_t *hash) {
+    for (size_t i = 0; i < hash->cantidad_baldes; i++) {
+        for (size_t j = 0; j < POSICIONES_BALDE; j++) {
+            if (!esta_libre(&hash->baldes[i].posiciones[j])) destruir_posicion(hash, &hash->baldes[i].posiciones[j]);
+        }
+    }
+    for (size_t i = 0; i < hash->en_escondite; i++) destruir_posicion(hash, &hash->escondite[i]);
+    free(hash->baldes);
+    free(hash);
+}
@@ -0,0 +1,79 @@
+#ifndef HASH_CUCO_H
+#define HASH_CUCO_H
+
+#include "hash.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Tabla de hash con hashing cuco: cada clave solo puede estar en uno de dos
+ * baldes de 2 posiciones o en un escondite de pocas claves para las que no
+ * hubo lugar. Cada balde ocupa una línea de caché y guarda dentro el hash,
+ * el dato y la clave si tiene hasta 15 bytes; las más largas van aparte.
+ * Una búsqueda lee las dos líneas de sus baldes, más la copia de la clave
+ * si es larga, y el escondite solo si no la encontró en los baldes y no
+ * está vacío, así que el peor caso no depende de la carga. Guardar puede
+ * tener que mover otras claves a su balde alternativo. La tabla crece al
+ * llenar el 85% de sus posiciones, o antes si se llena el escondite.
+ */
+struct hash_cuco;
+typedef struct hash_cuco hash_cuco_t;
+
+/* Crea el hash.
+ */
+hash_cuco_t *hash_cuco_crear(hash_destruir_dato_t destruir_dato);
+
+/* Guarda un elemento, reemplazando (y destruyendo) el dato si la clave ya
+ * estaba. De no poder guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_cuco_guardar(hash_cuco_t *hash, const char *clave, void *dato);
+
+/* Borra un elemento y devuelve el dato asociado, o NULL si no estaba.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_cuco_borrar(hash_cuco_t *hash, const char *clave);
+
+/* Obtiene el dato asociado a la clave, o NULL si no está.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_cuco_obtener(const hash_cuco_t *hash, const char *clave);
+
+/* Determina si la clave pertenece al hash.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_cuco_pertenece(const hash_cuco_t *hash, const char *clave);
+
+/* Devuelve la cantidad de elementos.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_cuco_cantidad(const hash_cuco_t *hash);
+
+/* Devuelve la cantidad de posiciones de los baldes, sin contar el escondite.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_cuco_capacidad(const hash_cuco_t *hash);
+
+/* Devuelve la cantidad de líneas de caché que lee la búsqueda de la clave:
+ * las de los dos baldes, las de las copias de claves largas que compara y
+ * las del escondite que recorre. Sirve para comprobar la cota de arriba.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_cuco_lineas_leidas(const hash_cuco_t *hash, const char *clave);
+
+// Tipo de función para visitar cada elemento, devuelve false para cortar el recorrido.
+typedef bool (*hash_cuco_visitar_t)(const char *clave, void *dato, void *extra);
+
+/* Llama a visitar con cada elemento y 'extra', hasta que visitar devuelva
+ * false. visitar no puede modificar el hash.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_cuco_recorrer(const hash_cuco_t *hash, hash_cuco_visitar_t visitar, void *extra);
+
+/* Destruye la estructura, llamando a la función destruir para cada dato.
+ * Pre: La estructura hash fue inicializada
+ * Post: La estructura hash fue destruida
+ */
+void hash_cuco_destruir(hash_cuco_t *hash);
+
+#endif  // HASH_CUCO_H
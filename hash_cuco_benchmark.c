@@ -0,0 +1,285 @@
+/*
+ * hash_cuco_benchmark.c
+ * Distribución de la latencia de búsqueda del hash cuco y del sondeo lineal.
+ *
+ * Compilación (programa aparte, no usa main.c):
+ *
+ *     gcc -O2 -std=gnu99 -pthread -o benchmark_cuco hash_cuco_benchmark.c hash_cuco.c hash.c
+ *
+ * Uso:
+ *
+ *     ./benchmark_cuco [-c capacidad] [-e carga] [-o operaciones] [-s semilla]
+ *
+ * Guarda capacidad * carga claves en cada tabla: el hash con sondeo lineal y
+ * con Robin Hood se crean con esa capacidad y esa carga máxima, así no
+ * crecen; el hash cuco llega solo a la misma capacidad mientras la carga no
+ * pase de 0.85. Las claves tienen 15 bytes, así el hash cuco las guarda
+ * dentro de sus baldes. Después mide una por una 'operaciones' búsquedas al
+ * azar de claves que están y que no están, e imprime el promedio y los
+ * percentiles en nanosegundos, y para el hash cuco el máximo de líneas de
+ * caché que leyó una búsqueda. Cada medición incluye el costo de leer el
+ * reloj, que se imprime aparte.
+ */
+
+#include "benchmark_comun.h"
+#include "hash.h"
+#include "hash_cuco.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>  // getopt
+
+// 15 caracteres y el '\0': entran dentro de un balde del hash cuco.
+#define LARGO_CLAVE 16
+// Las claves que no están se generan a partir de este identificador.
+#define ID_FALLOS (1ULL << 40)
+
+typedef struct config {
+    size_t capacidad;
+    double carga;
+    size_t operaciones;
+    uint64_t semilla;
+} config_t;
+
+// Las tablas se usan a través de esta interfaz.
+typedef struct variante {
+    const char *nombre;
+    void *(*crear)(const config_t *config);
+    bool (*guardar)(void *tabla, const char *clave, void *dato);
+    void *(*obtener)(const void *tabla, const char *clave);
+    void (*destruir)(void *tabla);
+    size_t (*lineas_leidas)(const void *tabla, const char *clave); // NULL si no se cuentan.
+} variante_t;
+
+static const double percentiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+/* ******************************************************************
+ *                        FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+// Como escribir_clave_aleatoria, pero con los 15 dígitos hexadecimales que entran en LARGO_CLAVE.
+static void escribir_clave_corta(char *clave, uint64_t id) {
+    snprintf(clave, LARGO_CLAVE, "%015llx", (unsigned long long) (mezclar(id) >> 4));
+}
+
+static int comparar_tiempos(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+/* ******************************************************************
+ *                            VARIANTES
+ * *****************************************************************/
+
+static void *crear_motor(const config_t *config, hash_motor_t motor) {
+    hash_opciones_t opciones = { .motor = motor, .capacidad_inicial = config->capacidad,
+                                 .carga_maxima = config->carga };
+    return hash_crear_opciones(NULL, &opciones);
+}
+
+static void *lineal_crear(const config_t *config) {
+    return crear_motor(config, HASH_MOTOR_LINEAL);
+}
+
+static void *robin_hood_crear(const config_t *config) {
+    return crear_motor(config, HASH_MOTOR_ROBIN_HOOD);
+}
+
+static bool abierto_guardar(void *tabla, const char *clave, void *dato) {
+    return hash_guardar(tabla, clave, dato);
+}
+
+static void *abierto_obtener(const void *tabla, const char *clave) {
+    return hash_obtener(tabla, clave);
+}
+
+static void abierto_destruir(void *tabla) {
+    hash_destruir(tabla);
+}
+
+static void *cuco_crear(const config_t *config) {
+    (void) config;
+    return hash_cuco_crear(NULL);
+}
+
+static bool cuco_guardar(void *tabla, const char *clave, void *dato) {
+    return hash_cuco_guardar(tabla, clave, dato);
+}
+
+static void *cuco_obtener(const void *tabla, const char *clave) {
+    return hash_cuco_obtener(tabla, clave);
+}
+
+static void cuco_destruir(void *tabla) {
+    hash_cuco_destruir(tabla);
+}
+
+static size_t cuco_lineas_leidas(const void *tabla, const char *clave) {
+    return hash_cuco_lineas_leidas(tabla, clave);
+}
+
+static const variante_t variantes[] = {
+    { "lineal", lineal_crear, abierto_guardar, abierto_obtener, abierto_destruir, NULL },
+    { "robin_hood", robin_hood_crear, abierto_guardar, abierto_obtener, abierto_destruir, NULL },
+    { "cuco", cuco_crear, cuco_guardar, cuco_obtener, cuco_destruir, cuco_lineas_leidas },
+};
+
+/* ******************************************************************
+ *                            MEDICIÓN
+ * *****************************************************************/
+
+static void imprimir(const char *nombre, const char *tipo, uint64_t *tiempos, size_t cantidad) {
+    qsort(tiempos, cantidad, sizeof(uint64_t), comparar_tiempos);
+    uint64_t total = 0;
+    for (size_t i = 0; i < cantidad; i++) total += tiempos[i];
+
+    printf("%-11s %-8s %9.1f", nombre, tipo, (double) total / (double) cantidad);
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+        printf(" %9llu", (unsigned long long) tiempos[(size_t) (percentiles[i] * (double) (cantidad - 1))]);
+    }
+    printf(" %9llu\n", (unsigned long long) tiempos[cantidad - 1]);
+}
+
+/* Mide cada búsqueda por separado. Las claves se escriben antes de medir, y
+ * las que están guardan como dato su propio puntero para comprobar el
+ * resultado. Si la variante cuenta líneas de caché, deja en *lineas el
+ * máximo que leyó una búsqueda.
+ */
+static bool buscar(const variante_t *variante, const void *tabla, const config_t *config, const char *claves,
+                   size_t cantidad, bool aciertos, uint64_t *tiempos, size_t *lineas) {
+    char *buscadas = malloc(config->operaciones * LARGO_CLAVE);
+    const char **esperados = malloc(config->operaciones * sizeof(char *));
+    if (!buscadas || !esperados) {
+        free(buscadas);
+        free(esperados);
+        return false;
+    }
+
+    uint64_t estado = config->semilla;
+    for (size_t i = 0; i < config->operaciones; i++) {
+        size_t indice = aleatorio(&estado) % cantidad;
+        esperados[i] = aciertos ? claves + indice * LARGO_CLAVE : NULL;
+        if (aciertos) memcpy(buscadas + i * LARGO_CLAVE, esperados[i], LARGO_CLAVE);
+        else escribir_clave_corta(buscadas + i * LARGO_CLAVE, ID_FALLOS + indice);
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < config->operaciones; i++) {
+        uint64_t inicio = ahora_ns();
+        void *dato = variante->obtener(tabla, buscadas + i * LARGO_CLAVE);
+        tiempos[i] = ahora_ns() - inicio;
+        ok &= dato == esperados[i];
+    }
+    for (size_t i = 0; i < config->operaciones && variante->lineas_leidas; i++) {
+        size_t leidas = variante->lineas_leidas(tabla, buscadas + i * LARGO_CLAVE);
+        if (leidas > *lineas) *lineas = leidas;
+    }
+
+    free(buscadas);
+    free(esperados);
+    return ok;
+}
+
+static bool medir(const variante_t *variante, const config_t *config, const char *claves, size_t cantidad,
+                  uint64_t *tiempos) {
+    void *tabla = variante->crear(config);
+    if (!tabla) return false;
+
+    bool ok = true;
+    for (size_t i = 0; i < cantidad && ok; i++) {
+        ok = variante->guardar(tabla, claves + i * LARGO_CLAVE, (void *) (claves + i * LARGO_CLAVE));
+    }
+
+    size_t lineas_aciertos = 0, lineas_fallos = 0;
+    if (ok && (ok = buscar(variante, tabla, config, claves, cantidad, true, tiempos, &lineas_aciertos))) {
+        imprimir(variante->nombre, "acierto", tiempos, config->operaciones);
+    }
+    if (ok && (ok = buscar(variante, tabla, config, claves, cantidad, false, tiempos, &lineas_fallos))) {
+        imprimir(variante->nombre, "fallo", tiempos, config->operaciones);
+    }
+    if (ok && variante->lineas_leidas) {
+        printf("%-11s lineas de cache leidas como maximo: %zu en aciertos, %zu en fallos\n", variante->nombre,
+               lineas_aciertos, lineas_fallos);
+    }
+
+    variante->destruir(tabla);
+    return ok;
+}
+
+// Costo de leer el reloj dos veces, que se suma a cada medición.
+static uint64_t costo_reloj(void) {
+    uint64_t minimo = UINT64_MAX;
+    for (size_t i = 0; i < 1000; i++) {
+        uint64_t inicio = ahora_ns();
+        uint64_t fin = ahora_ns();
+        if (fin - inicio < minimo) minimo = fin - inicio;
+    }
+    return minimo;
+}
+
+/* ******************************************************************
+ *                        PROGRAMA PRINCIPAL
+ * *****************************************************************/
+
+static void uso(const char *programa) {
+    fprintf(stderr, "uso: %s [-c capacidad] [-e carga] [-o operaciones] [-s semilla]\n", programa);
+}
+
+static bool leer_config(config_t *config, int argc, char *argv[]) {
+    config->capacidad = 1 << 20;
+    config->carga = 0.85;
+    config->operaciones = 1000000;
+    config->semilla = 42;
+
+    int opcion;
+    while ((opcion = getopt(argc, argv, "c:e:o:s:")) != -1) {
+        switch (opcion) {
+            case 'c': if (!leer_numero(optarg, &config->capacidad)) return false; break;
+            case 'e': if (!leer_real(optarg, &config->carga)) return false; break;
+            case 'o': if (!leer_numero(optarg, &config->operaciones)) return false; break;
+            case 's': if (!leer_entero(optarg, &config->semilla)) return false; break;
+            default:
+                return false;
+        }
+    }
+    return capacidad_valida(config->capacidad) && config->carga > 0 && config->carga < 1 &&
+           config->operaciones > 0;
+}
+
+int main(int argc, char *argv[]) {
+    config_t config;
+    if (!leer_config(&config, argc, argv)) {
+        uso(argv[0]);
+        return 1;
+    }
+
+    size_t cantidad = (size_t) ((double) config.capacidad * config.carga);
+    char *claves = malloc(cantidad * LARGO_CLAVE);
+    uint64_t *tiempos = malloc(config.operaciones * sizeof(uint64_t));
+    if (!claves || !tiempos || cantidad == 0) {
+        fprintf(stderr, "no hay memoria suficiente\n");
+        free(claves);
+        free(tiempos);
+        return 1;
+    }
+    for (size_t i = 0; i < cantidad; i++) escribir_clave_corta(claves + i * LARGO_CLAVE, i);
+
+    printf("capacidad %zu, carga %.2f, claves %zu, operaciones %zu, costo del reloj %llu ns\n\n",
+           config.capacidad, config.carga, cantidad, config.operaciones, (unsigned long long) costo_reloj());
+    printf("%-11s %-8s %9s %9s %9s %9s %9s %9s\n", "variante", "busqueda", "promedio", "p50", "p90", "p99",
+           "p99.9", "maximo");
+
+    bool ok = true;
+    for (size_t v = 0; v < sizeof(variantes) / sizeof(variantes[0]) && ok; v++) {
+        ok = medir(&variantes[v], &config, claves, cantidad, tiempos);
+    }
+    if (!ok) fprintf(stderr, "ERROR: el hash devolvió resultados incorrectos\n");
+
+    free(claves);
+    free(tiempos);
+    return !ok;
+}
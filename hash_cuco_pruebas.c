@@ -0,0 +1,246 @@
+/*
+ * hash_cuco_pruebas.c
+ * Pruebas para la Tabla de Hash con hashing cuco
+ */
+
+#include "hash_cuco.h"
+#include "testing.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CLAVES_PRUEBA 20000
+#define LARGO_CLAVE_PRUEBA 32
+
+
+/* ******************************************************************
+ *                        PRUEBAS UNITARIAS
+ * *****************************************************************/
+
+static void prueba_hash_cuco_basico()
+{
+    hash_cuco_t* hash = hash_cuco_crear(NULL);
+
+    char *clave1 = "perro", *valor1 = "guau", *valor1b = "GUAU";
+    char *clave2 = "una clave bastante mas larga que un campo", *valor2 = "larga";
+    char *clave3 = "", *valor3 = "vacia";
+
+    print_test("Prueba hash cuco crear", hash);
+    print_test("Prueba hash cuco obtener clave1, es NULL, no existe", !hash_cuco_obtener(hash, clave1));
+    print_test("Prueba hash cuco guardar clave1", hash_cuco_guardar(hash, clave1, valor1));
+    print_test("Prueba hash cuco guardar clave2", hash_cuco_guardar(hash, clave2, valor2));
+    print_test("Prueba hash cuco guardar clave vacia", hash_cuco_guardar(hash, clave3, valor3));
+    print_test("Prueba hash cuco la cantidad de elementos es 3", hash_cuco_cantidad(hash) == 3);
+    print_test("Prueba hash cuco obtener clave2 es valor2", hash_cuco_obtener(hash, clave2) == valor2);
+    print_test("Prueba hash cuco obtener clave vacia es valor3", hash_cuco_obtener(hash, clave3) == valor3);
+    print_test("Prueba hash cuco reemplazar clave1", hash_cuco_guardar(hash, clave1, valor1b));
+    print_test("Prueba hash cuco obtener clave1 es valor1b", hash_cuco_obtener(hash, clave1) == valor1b);
+    print_test("Prueba hash cuco la cantidad de elementos sigue en 3", hash_cuco_cantidad(hash) == 3);
+    print_test("Prueba hash cuco borrar clave1 es valor1b", hash_cuco_borrar(hash, clave1) == valor1b);
+    print_test("Prueba hash cuco clave1 no pertenece", !hash_cuco_pertenece(hash, clave1));
+    print_test("Prueba hash cuco borrar clave1 de nuevo es NULL", !hash_cuco_borrar(hash, clave1));
+    print_test("Prueba hash cuco clave2 pertenece", hash_cuco_pertenece(hash, clave2));
+    print_test("Prueba hash cuco la cantidad de elementos es 2", hash_cuco_cantidad(hash) == 2);
+
+    hash_cuco_destruir(hash);
+}
+
+static bool contar(const char* clave, void* dato, void* extra)
+{
+    size_t* visitados = extra;
+    (*visitados)++;
+    return strcmp(clave, dato) == 0;
+}
+
+static void prueba_hash_cuco_volumen()
+{
+    hash_cuco_t* hash = hash_cuco_crear(free);
+    size_t capacidad_inicial = hash_cuco_capacidad(hash);
+    char (*claves)[LARGO_CLAVE_PRUEBA] = crear_claves_prueba(CLAVES_PRUEBA, LARGO_CLAVE_PRUEBA);
+
+    /* Antes de cada redimensión la tabla se llena hasta su carga máxima, así
+     * que las últimas claves de cada tamaño necesitan mover otras. */
+    bool ok = true;
+    for (size_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+        char* dato = malloc(LARGO_CLAVE_PRUEBA);
+        strcpy(dato, claves[i]);
+        ok = hash_cuco_guardar(hash, claves[i], dato);
+    }
+    print_test("Prueba hash cuco guardar muchos elementos", ok);
+    print_test("Prueba hash cuco la cantidad de elementos es correcta", hash_cuco_cantidad(hash) == CLAVES_PRUEBA);
+    size_t capacidad_llena = hash_cuco_capacidad(hash);
+    print_test("Prueba hash cuco la tabla crecio", capacidad_llena >= CLAVES_PRUEBA);
+
+    for (size_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+        char* dato = hash_cuco_obtener(hash, claves[i]);
+        ok = dato && strcmp(dato, claves[i]) == 0;
+    }
+    print_test("Prueba hash cuco todas las claves tienen su dato", ok);
+
+    for (size_t i = 0; i < CLAVES_PRUEBA && ok; i += 3) {
+        char* dato = hash_cuco_borrar(hash, claves[i]);
+        ok = dato && strcmp(dato, claves[i]) == 0;
+        free(dato);
+    }
+    for (size_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+        ok = hash_cuco_pertenece(hash, claves[i]) == (i % 3 != 0);
+    }
+    print_test("Prueba hash cuco borrar un tercio y buscar el resto", ok);
+
+    size_t visitados = 0;
+    hash_cuco_recorrer(hash, contar, &visitados);
+    print_test("Prueba hash cuco recorrer visita todos los elementos",
+               visitados == hash_cuco_cantidad(hash) && visitados == CLAVES_PRUEBA - (CLAVES_PRUEBA + 2) / 3);
+
+    /* Borrar casi todo achica la tabla */
+    for (size_t i = 10; i < CLAVES_PRUEBA; i++) {
+        if (i % 3 != 0) free(hash_cuco_borrar(hash, claves[i]));
+    }
+    for (size_t i = 1; i < 10 && ok; i++) {
+        ok = i % 3 == 0 || hash_cuco_pertenece(hash, claves[i]);
+    }
+    print_test("Prueba hash cuco quedan los elementos no borrados", ok && hash_cuco_cantidad(hash) == 6);
+    print_test("Prueba hash cuco la tabla se achico a su capacidad inicial",
+               hash_cuco_capacidad(hash) == capacidad_inicial && capacidad_inicial < capacidad_llena);
+
+    free(claves);
+    hash_cuco_destruir(hash);
+}
+
+/* La tabla no crece hasta que la cantidad llega al 85% de sus posiciones */
+static void prueba_hash_cuco_carga_maxima()
+{
+    hash_cuco_t* hash = hash_cuco_crear(NULL);
+    size_t capacidad = hash_cuco_capacidad(hash);
+    size_t maximo = capacidad * 85 / 100;
+    char (*claves)[LARGO_CLAVE_PRUEBA] = crear_claves_prueba(maximo + 1, LARGO_CLAVE_PRUEBA);
+
+    bool ok = true;
+    for (size_t i = 0; i < maximo && ok; i++) ok = hash_cuco_guardar(hash, claves[i], claves[i]);
+    print_test("Prueba hash cuco carga maxima llenar hasta el 85%", ok && hash_cuco_cantidad(hash) == maximo);
+    print_test("Prueba hash cuco carga maxima la tabla no crecio", hash_cuco_capacidad(hash) == capacidad);
+    for (size_t i = 0; i < maximo && ok; i++) ok = hash_cuco_obtener(hash, claves[i]) == claves[i];
+    print_test("Prueba hash cuco carga maxima todas las claves se encuentran", ok);
+
+    ok = hash_cuco_guardar(hash, claves[maximo], claves[maximo]);
+    print_test("Prueba hash cuco carga maxima una clave mas la hace crecer", ok && hash_cuco_capacidad(hash) > capacidad);
+
+    free(claves);
+    hash_cuco_destruir(hash);
+}
+
+/* Con la tabla en su carga máxima, una búsqueda de una clave corta lee solo
+ * sus dos baldes, salvo que tenga que recorrer el escondite. Una clave larga
+ * lee además su copia. */
+#define CLAVES_LINEAS 27852 // El 85% de 32768 posiciones.
+#define LINEAS_ESCONDITE 5 // 8 posiciones de 32 bytes, sin alinear.
+
+static void prueba_hash_cuco_lineas()
+{
+    hash_cuco_t* hash = hash_cuco_crear(NULL);
+    char (*claves)[LARGO_CLAVE_PRUEBA] = malloc(CLAVES_LINEAS * LARGO_CLAVE_PRUEBA);
+    char falta[LARGO_CLAVE_PRUEBA];
+
+    bool ok = true;
+    for (size_t i = 0; i < CLAVES_LINEAS && ok; i++) {
+        snprintf(claves[i], LARGO_CLAVE_PRUEBA, "c%zu", i);
+        ok = hash_cuco_guardar(hash, claves[i], claves[i]);
+    }
+    print_test("Prueba hash cuco lineas llenar hasta la carga maxima", ok && hash_cuco_capacidad(hash) == 32768);
+
+    /* Solo las claves del escondite leen más de dos líneas */
+    size_t mas_de_dos = 0, maximo = 0;
+    for (size_t i = 0; i < CLAVES_LINEAS; i++) {
+        size_t lineas = hash_cuco_lineas_leidas(hash, claves[i]);
+        if (lineas > 2) mas_de_dos++;
+        if (lineas > maximo) maximo = lineas;
+    }
+    print_test("Prueba hash cuco lineas los aciertos leen dos lineas", mas_de_dos <= 8 && maximo <= 2 + LINEAS_ESCONDITE);
+
+    size_t fallo = 0;
+    for (size_t i = 0; i < CLAVES_LINEAS && ok; i++) {
+        snprintf(falta, sizeof(falta), "f%zu", i);
+        size_t lineas = hash_cuco_lineas_leidas(hash, falta);
+        if (i == 0) fallo = lineas;
+        ok = lineas == fallo;
+    }
+    print_test("Prueba hash cuco lineas los fallos leen siempre lo mismo", ok && fallo >= 2 && fallo <= 2 + LINEAS_ESCONDITE);
+
+    char *larga = "una clave bastante mas larga que un campo";
+    ok = hash_cuco_guardar(hash, larga, larga);
+    size_t lineas = hash_cuco_lineas_leidas(hash, larga);
+    print_test("Prueba hash cuco lineas una clave larga lee ademas su copia", ok && lineas > 2 && lineas <= 4 + LINEAS_ESCONDITE);
+
+    free(claves);
+    hash_cuco_destruir(hash);
+}
+
+/* Busca claves cuyos dos baldes caigan en los dos primeros de una tabla de
+ * BALDES baldes. Sus 4 posiciones se llenan enseguida y el resto de esas
+ * claves solo entra en el escondite. */
+#define BALDES 16
+#define CLAVES_CHOCAN 13
+
+static void buscar_claves_que_chocan(char claves[][LARGO_CLAVE_PRUEBA], size_t cantidad)
+{
+    size_t encontradas = 0;
+    for (unsigned i = 0; encontradas < cantidad; i++) {
+        snprintf(claves[encontradas], LARGO_CLAVE_PRUEBA, "k%u", i);
+        uint64_t h = hash_wyhash(claves[encontradas], strlen(claves[encontradas]));
+        if ((h & (BALDES - 1)) < 2 && ((h >> 32) & (BALDES - 1)) < 2) encontradas++;
+    }
+}
+
+static void prueba_hash_cuco_escondite()
+{
+    hash_cuco_t* hash = hash_cuco_crear(NULL);
+    size_t capacidad_inicial = hash_cuco_capacidad(hash);
+    char claves[CLAVES_CHOCAN][LARGO_CLAVE_PRUEBA];
+    buscar_claves_que_chocan(claves, CLAVES_CHOCAN);
+    print_test("Prueba hash cuco escondite la tabla empieza con 16 baldes", capacidad_inicial == BALDES * 2);
+
+    /* 4 claves van a los baldes y 8 al escondite, todavía lejos de la carga máxima */
+    bool ok = true;
+    for (size_t i = 0; i < CLAVES_CHOCAN - 1 && ok; i++) ok = hash_cuco_guardar(hash, claves[i], claves[i]);
+    print_test("Prueba hash cuco escondite guardar 12 claves que chocan", ok);
+    print_test("Prueba hash cuco escondite la tabla no crecio", hash_cuco_capacidad(hash) == capacidad_inicial);
+    for (size_t i = 0; i < CLAVES_CHOCAN - 1 && ok; i++) ok = hash_cuco_obtener(hash, claves[i]) == claves[i];
+    print_test("Prueba hash cuco escondite todas las claves se encuentran", ok);
+
+    size_t visitados = 0;
+    hash_cuco_recorrer(hash, contar, &visitados);
+    print_test("Prueba hash cuco escondite recorrer visita el escondite", visitados == CLAVES_CHOCAN - 1);
+
+    /* Borrar en orden inverso saca primero las claves del escondite */
+    for (size_t i = CLAVES_CHOCAN - 1; i-- > 0 && ok;) ok = hash_cuco_borrar(hash, claves[i]) == claves[i];
+    print_test("Prueba hash cuco escondite borrar todas las claves", ok && hash_cuco_cantidad(hash) == 0);
+    for (size_t i = 0; i < CLAVES_CHOCAN - 1 && ok; i++) ok = !hash_cuco_pertenece(hash, claves[i]);
+    print_test("Prueba hash cuco escondite ninguna clave pertenece", ok);
+
+    /* Con el escondite lleno la clave 13 obliga a crecer antes de la carga máxima */
+    for (size_t i = 0; i < CLAVES_CHOCAN && ok; i++) ok = hash_cuco_guardar(hash, claves[i], claves[i]);
+    print_test("Prueba hash cuco escondite guardar 13 claves que chocan", ok);
+    print_test("Prueba hash cuco escondite la tabla crecio", hash_cuco_capacidad(hash) > capacidad_inicial);
+    for (size_t i = 0; i < CLAVES_CHOCAN && ok; i++) ok = hash_cuco_obtener(hash, claves[i]) == claves[i];
+    print_test("Prueba hash cuco escondite las claves siguen estando", ok && hash_cuco_cantidad(hash) == CLAVES_CHOCAN);
+
+    hash_cuco_destruir(hash);
+}
+
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+
+void pruebas_hash_cuco()
+{
+    /* Ejecuta todas las pruebas unitarias. */
+    prueba_hash_cuco_basico();
+    prueba_hash_cuco_volumen();
+    prueba_hash_cuco_carga_maxima();
+    prueba_hash_cuco_lineas();
+    prueba_hash_cuco_escondite();
+}
@@ -0,0 +1,75 @@
+#include "hash_entero.h"
+#include "hash_tipado.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Sondeo lineal sin marcas de borrado, generado con hash_tipado.h: los
+ * bytes de control valen VACIO o los 7 bits altos del hash de la clave, así
+ * la mayoría de las posiciones que no coinciden se descartan sin leer el
+ * campo.
+ */
+HASH_TIPADO_DECLARAR(tabla_entera, uint64_t, void *, hash_tipado_entero, HASH_TIPADO_IGUALES)
+
+struct hash_entero{
+  tabla_entera_t tabla;
+  hash_destruir_dato_t destruir_dato;
+};
+
+hash_entero_t *hash_entero_crear(hash_destruir_dato_t destruir_dato) {
+    hash_entero_t *hash = malloc(sizeof(hash_entero_t));
+    if (!hash) return NULL;
+    if (!tabla_entera_inicializar(&hash->tabla)) {
+        free(hash);
+        return NULL;
+    }
+    hash->destruir_dato = destruir_dato;
+    return hash;
+}
+
+bool hash_entero_guardar(hash_entero_t *hash, uint64_t clave, void *dato) {
+    bool agregada;
+    void **lugar = tabla_entera_lugar(&hash->tabla, clave, &agregada);
+    if (!lugar) return false;
+    if (!agregada && hash->destruir_dato) hash->destruir_dato(*lugar);
+    *lugar = dato;
+    return true;
+}
+
+void *hash_entero_borrar(hash_entero_t *hash, uint64_t clave) {
+    void *dato = NULL;
+    tabla_entera_borrar(&hash->tabla, clave, &dato);
+    return dato;
+}
+
+void *hash_entero_obtener(const hash_entero_t *hash, uint64_t clave) {
+    void **dato = tabla_entera_obtener(&hash->tabla, clave);
+    return dato ? *dato : NULL;
+}
+
+bool hash_entero_pertenece(const hash_entero_t *hash, uint64_t clave) {
+    return tabla_entera_pertenece(&hash->tabla, clave);
+}
+
+size_t hash_entero_cantidad(const hash_entero_t *hash) {
+    return tabla_entera_cantidad(&hash->tabla);
+}
+
+void hash_entero_recorrer(const hash_entero_t *hash, hash_entero_visitar_t visitar, void *extra) {
+    size_t posicion = 0;
+    uint64_t clave;
+    void *dato;
+    while (tabla_entera_siguiente(&hash->tabla, &posicion, &clave, &dato)) {
+        if (!visitar(clave, dato, extra)) return;
+    }
+}
+
+void hash_entero_destruir(hash_entero_t *hash) {
+    size_t posicion = 0;
+    void *dato;
+    while (hash->destruir_dato && tabla_entera_siguiente(&hash->tabla, &posicion, NULL, &dato)) {
+        hash->destruir_dato(dato);
+    }
+    tabla_entera_liberar(&hash->tabla);
+    free(hash);
+}
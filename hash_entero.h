@@ -0,0 +1,62 @@
+#ifndef HASH_ENTERO_H
+#define HASH_ENTERO_H
+
+#include "hash.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Tabla de hash con claves enteras de 64 bits. Cada clave se guarda en la
+ * tabla junto a su dato, así que guardar no pide memoria salvo al
+ * redimensionar, y los números no se convierten a cadenas para buscarlos.
+ */
+struct hash_entero;
+typedef struct hash_entero hash_entero_t;
+
+/* Crea el hash.
+ */
+hash_entero_t *hash_entero_crear(hash_destruir_dato_t destruir_dato);
+
+/* Guarda un elemento, reemplazando (y destruyendo) el dato si la clave ya
+ * estaba. De no poder guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_entero_guardar(hash_entero_t *hash, uint64_t clave, void *dato);
+
+/* Borra un elemento y devuelve el dato asociado, o NULL si no estaba.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_entero_borrar(hash_entero_t *hash, uint64_t clave);
+
+/* Obtiene el dato asociado a la clave, o NULL si no está.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_entero_obtener(const hash_entero_t *hash, uint64_t clave);
+
+/* Determina si la clave pertenece al hash.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_entero_pertenece(const hash_entero_t *hash, uint64_t clave);
+
+/* Devuelve la cantidad de elementos.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_entero_cantidad(const hash_entero_t *hash);
+
+// Tipo de función para visitar cada elemento, devuelve false para cortar el recorrido.
+typedef bool (*hash_entero_visitar_t)(uint64_t clave, void *dato, void *extra);
+
+/* Llama a visitar con cada elemento y 'extra', hasta que visitar devuelva
+ * false. visitar no puede modificar el hash.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_entero_recorrer(const hash_entero_t *hash, hash_entero_visitar_t visitar, void *extra);
+
+/* Destruye la estructura, llamando a la función destruir para cada dato.
+ * Pre: La estructura hash fue inicializada
+ * Post: La estructura hash fue destruida
+ */
+void hash_entero_destruir(hash_entero_t *hash);
+
+#endif  // HASH_ENTERO_H
@@ -0,0 +1,107 @@
+/*
+ * hash_entero_pruebas.c
+ * Pruebas para la Tabla de Hash con claves enteras
+ */
+
+#include "hash_entero.h"
+#include "testing.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CLAVES_PRUEBA 20000
+
+
+/* ******************************************************************
+ *                        PRUEBAS UNITARIAS
+ * *****************************************************************/
+
+static void prueba_hash_entero_basico()
+{
+    hash_entero_t* hash = hash_entero_crear(NULL);
+
+    char *valor1 = "cero", *valor2 = "maximo", *valor2b = "MAXIMO";
+
+    print_test("Prueba hash entero crear", hash);
+    print_test("Prueba hash entero obtener 0, es NULL, no existe", !hash_entero_obtener(hash, 0));
+    print_test("Prueba hash entero guardar 0", hash_entero_guardar(hash, 0, valor1));
+    print_test("Prueba hash entero guardar UINT64_MAX", hash_entero_guardar(hash, UINT64_MAX, valor2));
+    print_test("Prueba hash entero la cantidad de elementos es 2", hash_entero_cantidad(hash) == 2);
+    print_test("Prueba hash entero obtener 0 es valor1", hash_entero_obtener(hash, 0) == valor1);
+    print_test("Prueba hash entero reemplazar UINT64_MAX", hash_entero_guardar(hash, UINT64_MAX, valor2b));
+    print_test("Prueba hash entero obtener UINT64_MAX es valor2b", hash_entero_obtener(hash, UINT64_MAX) == valor2b);
+    print_test("Prueba hash entero la cantidad de elementos sigue en 2", hash_entero_cantidad(hash) == 2);
+    print_test("Prueba hash entero borrar 0 es valor1", hash_entero_borrar(hash, 0) == valor1);
+    print_test("Prueba hash entero 0 no pertenece", !hash_entero_pertenece(hash, 0));
+    print_test("Prueba hash entero borrar 0 de nuevo es NULL", !hash_entero_borrar(hash, 0));
+    print_test("Prueba hash entero la cantidad de elementos es 1", hash_entero_cantidad(hash) == 1);
+
+    hash_entero_destruir(hash);
+}
+
+static bool contar(uint64_t clave, void* dato, void* extra)
+{
+    size_t* visitados = extra;
+    (*visitados)++;
+    return *(uint64_t*) dato == clave;
+}
+
+static void prueba_hash_entero_volumen()
+{
+    hash_entero_t* hash = hash_entero_crear(free);
+
+    /* Claves secuenciales y múltiplos de potencias de dos, que chocan en los bits bajos */
+    bool ok = true;
+    for (uint64_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+        uint64_t* dato = malloc(sizeof(uint64_t));
+        *dato = i % 2 ? i : i << 32;
+        ok = hash_entero_guardar(hash, *dato, dato);
+    }
+    print_test("Prueba hash entero guardar muchos elementos", ok);
+    print_test("Prueba hash entero la cantidad de elementos es correcta", hash_entero_cantidad(hash) == CLAVES_PRUEBA);
+
+    /* Los borrados corren campos hacia atrás: los que quedan se siguen encontrando */
+    for (uint64_t i = 0; i < CLAVES_PRUEBA && ok; i += 3) {
+        uint64_t clave = i % 2 ? i : i << 32;
+        uint64_t* dato = hash_entero_borrar(hash, clave);
+        ok = dato && *dato == clave;
+        free(dato);
+    }
+    for (uint64_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+        uint64_t clave = i % 2 ? i : i << 32;
+        uint64_t* dato = hash_entero_obtener(hash, clave);
+        ok = i % 3 ? dato && *dato == clave : !dato;
+    }
+    print_test("Prueba hash entero borrar un tercio y buscar el resto", ok);
+
+    size_t visitados = 0;
+    hash_entero_recorrer(hash, contar, &visitados);
+    print_test("Prueba hash entero recorrer visita todos los elementos",
+               visitados == hash_entero_cantidad(hash) && visitados == CLAVES_PRUEBA - (CLAVES_PRUEBA + 2) / 3);
+
+    /* Borrar casi todo achica la tabla */
+    for (uint64_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+        if (i % 3 == 0 || i < 10) continue;
+        free(hash_entero_borrar(hash, i % 2 ? i : i << 32));
+    }
+    for (uint64_t i = 1; i < 10 && ok; i++) {
+        ok = i % 3 == 0 || hash_entero_pertenece(hash, i % 2 ? i : i << 32);
+    }
+    print_test("Prueba hash entero quedan los elementos no borrados", ok && hash_entero_cantidad(hash) == 6);
+
+    hash_entero_destruir(hash);
+}
+
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+
+void pruebas_hash_entero()
+{
+    /* Ejecuta todas las pruebas unitarias. */
+    prueba_hash_entero_basico();
+    prueba_hash_entero_volumen();
+}
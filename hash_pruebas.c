@@ -8,6 +8,7 @@
 #include "hash.h"
 #include "testing.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -176,6 +177,38 @@ static void prueba_hash_borrar()
     hash_destruir(hash);
 }
 
+static void prueba_hash_obtener_o_guardar()
+{
+    hash_t* hash = hash_crear(free);
+
+    char *palabras[] = {"perro", "gato", "perro", "vaca", "perro", "gato"};
+    size_t cantidad_palabras = sizeof(palabras) / sizeof(char *);
+
+    /* Cuenta apariciones con una sola búsqueda por palabra */
+    bool ok = true;
+    size_t nuevas = 0;
+    for (size_t i = 0; i < cantidad_palabras && ok; i++) {
+        bool guardado;
+        void **dato = hash_obtener_o_guardar(hash, palabras[i], NULL, &guardado);
+        ok = dato != NULL;
+        if (!ok) break;
+        if (guardado) {
+            ok = *dato == NULL;
+            *dato = calloc(1, sizeof(int));
+            nuevas++;
+        }
+        (*(int *) *dato)++;
+    }
+    print_test("Prueba hash obtener o guardar cada palabra", ok);
+    print_test("Prueba hash obtener o guardar agrega solo las palabras nuevas", nuevas == 3);
+    print_test("Prueba hash la cantidad de elementos es 3", hash_cantidad(hash) == 3);
+    print_test("Prueba hash perro aparece 3 veces", *(int *) hash_obtener(hash, "perro") == 3);
+    print_test("Prueba hash gato aparece 2 veces", *(int *) hash_obtener(hash, "gato") == 2);
+    print_test("Prueba hash vaca aparece 1 vez", *(int *) hash_obtener(hash, "vaca") == 1);
+
+    hash_destruir(hash);
+}
+
 static void prueba_hash_clave_vacia()
 {
     hash_t* hash = hash_crear(NULL);
@@ -209,6 +242,73 @@ static void prueba_hash_valor_null()
     hash_destruir(hash);
 }
 
+static void prueba_hash_claves_de_distinto_largo()
+{
+    hash_t* hash = hash_crear(NULL);
+
+    /* Claves alrededor del largo que se guarda dentro de la tabla */
+    char *clave14 = "abcdefghijklmn", *valor14 = "14";
+    char *clave15 = "abcdefghijklmno", *valor15 = "15";
+    char *clave16 = "abcdefghijklmnop", *valor16 = "16";
+
+    print_test("Prueba hash insertar clave de 14 caracteres", hash_guardar(hash, clave14, valor14));
+    print_test("Prueba hash insertar clave de 15 caracteres", hash_guardar(hash, clave15, valor15));
+    print_test("Prueba hash insertar clave de 16 caracteres", hash_guardar(hash, clave16, valor16));
+    print_test("Prueba hash obtener clave de 14 caracteres", hash_obtener(hash, clave14) == valor14);
+    print_test("Prueba hash obtener clave de 15 caracteres", hash_obtener(hash, clave15) == valor15);
+    print_test("Prueba hash obtener clave de 16 caracteres", hash_obtener(hash, clave16) == valor16);
+
+    bool ok = true;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    while (!hash_iter_al_final(iter) && ok) {
+        const char *clave = hash_iter_ver_actual(iter);
+        ok = strcmp(clave, clave14) == 0 || strcmp(clave, clave15) == 0 || strcmp(clave, clave16) == 0;
+        hash_iter_avanzar(iter);
+    }
+    print_test("Prueba hash iterador devuelve las claves completas", ok);
+    hash_iter_destruir(iter);
+
+    print_test("Prueba hash borrar clave de 15 caracteres", hash_borrar(hash, clave15) == valor15);
+    print_test("Prueba hash borrar clave de 16 caracteres", hash_borrar(hash, clave16) == valor16);
+    print_test("Prueba hash la cantidad de elementos es 1", hash_cantidad(hash) == 1);
+
+    hash_destruir(hash);
+}
+
+static void prueba_hash_claves_binarias()
+{
+    hash_t* hash = hash_crear(NULL);
+
+    /* Claves con '\0' en el medio, cortas y largas */
+    char corta1[] = {'a', '\0', 'b'}, corta2[] = {'a', '\0', 'c'};
+    char larga[20] = {0};
+    larga[19] = 'z';
+    char *valor1 = "uno", *valor2 = "dos", *valor3 = "tres", *valor4 = "cuatro";
+
+    print_test("Prueba hash insertar clave binaria corta 1", hash_guardar_bytes(hash, corta1, sizeof(corta1), valor1));
+    print_test("Prueba hash insertar clave binaria corta 2", hash_guardar_bytes(hash, corta2, sizeof(corta2), valor2));
+    print_test("Prueba hash insertar clave binaria larga", hash_guardar_bytes(hash, larga, sizeof(larga), valor3));
+    print_test("Prueba hash insertar clave de texto \"a\"", hash_guardar(hash, "a", valor4));
+    print_test("Prueba hash la cantidad de elementos es 4", hash_cantidad(hash) == 4);
+
+    print_test("Prueba hash obtener clave binaria corta 1", hash_obtener_bytes(hash, corta1, sizeof(corta1)) == valor1);
+    print_test("Prueba hash obtener clave binaria corta 2", hash_obtener_bytes(hash, corta2, sizeof(corta2)) == valor2);
+    print_test("Prueba hash obtener clave binaria larga", hash_obtener_bytes(hash, larga, sizeof(larga)) == valor3);
+    print_test("Prueba hash pertenece prefijo de clave larga, es false", !hash_pertenece_bytes(hash, larga, 19));
+
+    /* Un prefijo de un buffer sin '\0' es la misma clave que el texto */
+    char buffer[] = {'a', 'x', 'y'};
+    print_test("Prueba hash obtener prefijo de buffer es la clave de texto", hash_obtener_bytes(hash, buffer, 1) == valor4);
+    print_test("Prueba hash obtener clave de 0 bytes es NULL", !hash_obtener_bytes(hash, buffer, 0));
+
+    print_test("Prueba hash borrar clave binaria corta 1", hash_borrar_bytes(hash, corta1, sizeof(corta1)) == valor1);
+    print_test("Prueba hash borrar clave binaria larga", hash_borrar_bytes(hash, larga, sizeof(larga)) == valor3);
+    print_test("Prueba hash pertenece clave binaria corta 2", hash_pertenece_bytes(hash, corta2, sizeof(corta2)));
+    print_test("Prueba hash la cantidad de elementos es 2", hash_cantidad(hash) == 2);
+
+    hash_destruir(hash);
+}
+
 static void prueba_hash_volumen(size_t largo, bool debug)
 {
     hash_t* hash = hash_crear(NULL);
@@ -269,6 +369,1062 @@ static void prueba_hash_volumen(size_t largo, bool debug)
 
 }
 
+static void prueba_hash_borrar_reinsertar_volumen(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+
+    char clave[24];
+    bool ok = true;
+
+    /* Guarda y borra claves siempre distintas: la cantidad no pasa de 1 pero
+     * los lugares borrados se acumulan si nunca se recuperan. */
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%08zu", i);
+        ok = hash_guardar(hash, clave, clave);
+        if (!ok) break;
+        ok = hash_borrar(hash, clave) == clave;
+        if (!ok) break;
+    }
+
+    print_test("Prueba hash guardar y borrar muchas claves distintas", ok);
+    print_test("Prueba hash la cantidad de elementos es 0", hash_cantidad(hash) == 0);
+    print_test("Prueba hash pertenece clave no guardada, es false", !hash_pertenece(hash, "no esta"));
+    print_test("Prueba hash obtener clave no guardada, es NULL", !hash_obtener(hash, "no esta"));
+
+    hash_destruir(hash);
+}
+
+static void prueba_hash_robin_hood_volumen(size_t largo)
+{
+    hash_t* hash = hash_crear_motor(NULL, HASH_MOTOR_ROBIN_HOOD);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+
+    /* Inserta 'largo' claves usando la propia clave como valor */
+    bool ok = true;
+    for (unsigned i = 0; i < largo; i++) {
+        sprintf(claves[i], "%08d", i);
+        ok = hash_guardar(hash, claves[i], claves[i]);
+        if (!ok) break;
+    }
+    print_test("Prueba hash Robin Hood almacenar muchos elementos", ok);
+    print_test("Prueba hash Robin Hood la cantidad de elementos es correcta", hash_cantidad(hash) == largo);
+
+    /* Borra las claves pares: las impares deben seguir encontrándose */
+    for (size_t i = 0; i < largo && ok; i += 2) {
+        ok = hash_borrar(hash, claves[i]) == claves[i];
+    }
+    print_test("Prueba hash Robin Hood borrar la mitad de los elementos", ok);
+
+    for (size_t i = 0; i < largo && ok; i++) {
+        if (i % 2 == 0) ok = !hash_pertenece(hash, claves[i]) && !hash_obtener(hash, claves[i]);
+        else ok = hash_obtener(hash, claves[i]) == claves[i];
+    }
+    print_test("Prueba hash Robin Hood obtener luego de borrar", ok);
+    print_test("Prueba hash Robin Hood la cantidad de elementos es la mitad", hash_cantidad(hash) == largo / 2);
+
+    /* Vuelve a guardar las pares y recorre todo con el iterador */
+    for (size_t i = 0; i < largo && ok; i += 2) {
+        ok = hash_guardar(hash, claves[i], claves[i]);
+    }
+    size_t recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    while (!hash_iter_al_final(iter) && ok) {
+        const char *clave = hash_iter_ver_actual(iter);
+        ok = hash_obtener(hash, clave) != NULL;
+        recorridos++;
+        hash_iter_avanzar(iter);
+    }
+    print_test("Prueba hash Robin Hood reinsertar y recorrer todo", ok && recorridos == largo);
+
+    hash_iter_destruir(iter);
+    free(claves);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_arena_volumen(size_t largo)
+{
+    hash_opciones_t opciones = { .claves_en_arena = true };
+    hash_t* hash = hash_crear_opciones(free, &opciones);
+
+    const size_t largo_clave = 24;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+
+    /* Inserta 'largo' claves, largas para que no entren en la tabla, con
+     * valores que el hash debe liberar */
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(claves[i], "clave-larga-%08d", i);
+        ok = hash_guardar(hash, claves[i], malloc(sizeof(int)));
+    }
+    print_test("Prueba hash arena almacenar muchos elementos", ok);
+
+    /* Borra y vuelve a guardar: las claves nuevas reutilizan el lugar de las borradas */
+    for (size_t i = 0; i < largo && ok; i += 2) {
+        free(hash_borrar(hash, claves[i]));
+        ok = !hash_pertenece(hash, claves[i]);
+    }
+    for (size_t i = 0; i < largo && ok; i += 2) {
+        ok = hash_guardar(hash, claves[i], malloc(sizeof(int)));
+    }
+    print_test("Prueba hash arena borrar y reinsertar", ok);
+
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_pertenece(hash, claves[i]);
+    }
+    print_test("Prueba hash arena pertenecen todos los elementos", ok);
+    print_test("Prueba hash arena la cantidad de elementos es correcta", hash_cantidad(hash) == largo);
+
+    /* Una clave más grande que un bloque de la arena */
+    size_t largo_grande = 100000;
+    char *grande = malloc(largo_grande + 1);
+    memset(grande, 'a', largo_grande);
+    grande[largo_grande] = '\0';
+    print_test("Prueba hash arena insertar clave muy larga", hash_guardar(hash, grande, malloc(sizeof(int))));
+    print_test("Prueba hash arena pertenece clave muy larga", hash_pertenece(hash, grande));
+    print_test("Prueba hash arena pertenece una clave anterior", hash_pertenece(hash, claves[0]));
+
+    free(grande);
+    free(claves);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_obtener_lote(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+
+    const size_t largo_clave = 24;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    const char **lote = malloc(largo * sizeof(char *));
+    void **datos = malloc(largo * sizeof(void *));
+
+    /* Guarda solo las claves pares; el lote pide todas */
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(claves[i], i % 4 ? "%08d" : "clave-larga-%08d", i);
+        lote[i] = claves[i];
+        if (i % 2 == 0) ok = hash_guardar(hash, claves[i], claves[i]);
+    }
+
+    hash_obtener_lote(hash, lote, largo, datos);
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = datos[i] == (i % 2 == 0 ? claves[i] : NULL);
+    }
+    print_test("Prueba hash obtener lote devuelve los mismos valores que obtener", ok);
+
+    free(datos);
+    free(lote);
+    free(claves);
+    hash_destruir(hash);
+}
+
+/* Cada motor con cada función de hash, con y sin arena de claves y con y sin
+ * redimensión incremental. */
+#define MOTORES_PRUEBA 2
+#define FUNCIONES_PRUEBA 2
+#define LARGO_CLAVE_OPCIONES 24
+
+// Cuerpo de una prueba para unas opciones, devuelve false si falla.
+typedef bool (*probar_opciones_t)(const hash_opciones_t* opciones, void* extra);
+
+/* Llama a probar con cada combinación de opciones de creación, hasta que una
+ * falle. Devuelve true si ninguna falló. */
+static bool probar_todas_las_opciones(probar_opciones_t probar, void* extra)
+{
+    hash_motor_t motores[MOTORES_PRUEBA] = {HASH_MOTOR_LINEAL, HASH_MOTOR_ROBIN_HOOD};
+    hash_funcion_t funciones[FUNCIONES_PRUEBA] = {HASH_FUNCION_WYHASH, HASH_FUNCION_DJB2};
+
+    bool ok = true;
+    for (size_t m = 0; m < MOTORES_PRUEBA && ok; m++) {
+        for (size_t f = 0; f < FUNCIONES_PRUEBA && ok; f++) {
+            for (int arena = 0; arena < 2 && ok; arena++) {
+                for (int incremental = 0; incremental < 2 && ok; incremental++) {
+                    hash_opciones_t opciones = {
+                        .motor = motores[m], .funcion = funciones[f], .claves_en_arena = arena,
+                        .redimension_incremental = incremental
+                    };
+                    ok = probar(&opciones, extra);
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+// Claves que comparten las pruebas con todas las opciones.
+typedef struct claves_opciones {
+    size_t largo;
+    char (*claves)[LARGO_CLAVE_OPCIONES];
+} claves_opciones_t;
+
+static bool guardar_obtener_y_borrar(const hash_opciones_t* opciones, void* extra)
+{
+    claves_opciones_t* prueba = extra;
+    size_t largo = prueba->largo;
+    char (*claves)[LARGO_CLAVE_OPCIONES] = prueba->claves;
+    hash_t* hash = hash_crear_opciones(NULL, opciones);
+
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_guardar(hash, claves[i], claves[i]);
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        bool guardado;
+        void **dato = hash_obtener_o_guardar(hash, claves[i], NULL, &guardado);
+        ok = dato && !guardado && *dato == claves[i];
+    }
+    for (size_t i = 0; i < largo && ok; i += 3) {
+        ok = hash_borrar(hash, claves[i]) == claves[i];
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_obtener(hash, claves[i]) == (i % 3 ? claves[i] : NULL);
+    }
+    ok = ok && hash_cantidad(hash) == largo - (largo + 2) / 3;
+    hash_destruir(hash);
+    return ok;
+}
+
+/* Guarda, busca y borra claves con cada combinación de opciones de creación. */
+static void prueba_hash_opciones_volumen(size_t largo)
+{
+    claves_opciones_t prueba = { largo, crear_claves_prueba(largo, LARGO_CLAVE_OPCIONES) };
+    bool ok = probar_todas_las_opciones(guardar_obtener_y_borrar, &prueba);
+    print_test("Prueba hash guardar, obtener y borrar con todas las opciones", ok);
+
+    free(prueba.claves);
+}
+
+static bool redimensionar_mientras_se_usa(const hash_opciones_t* opciones, void* extra)
+{
+    claves_opciones_t* prueba = extra;
+    size_t largo = prueba->largo;
+    char (*claves)[LARGO_CLAVE_OPCIONES] = prueba->claves;
+    hash_t* hash = hash_crear_opciones(free, opciones);
+
+    /* Busca, reemplaza y borra claves mientras la tabla se está migrando */
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        unsigned *dato = malloc(sizeof(unsigned));
+        *dato = (unsigned) i;
+        ok = hash_guardar(hash, claves[i], dato);
+        ok = ok && hash_obtener(hash, claves[i]) == dato;
+        ok = ok && (i / 2 % 5 == 0 || *(unsigned*) hash_obtener(hash, claves[i / 2]) == i / 2);
+        if (ok && i % 5 == 4) {
+            dato = malloc(sizeof(unsigned));
+            *dato = (unsigned) (i - 2);
+            ok = hash_guardar(hash, claves[i - 2], dato);
+            free(hash_borrar(hash, claves[i - 4]));
+            ok = ok && !hash_pertenece(hash, claves[i - 4]);
+        }
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        unsigned *dato = hash_obtener(hash, claves[i]);
+        ok = i % 5 == 0 && i + 4 < largo ? !dato : dato && *dato == i;
+    }
+    ok = ok && hash_cantidad(hash) == largo - largo / 5;
+
+    /* El iterador recorre las dos tablas */
+    size_t iterados = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    while (!hash_iter_al_final(iter)) {
+        ok = ok && hash_pertenece(hash, hash_iter_ver_actual(iter));
+        iterados++;
+        hash_iter_avanzar(iter);
+    }
+    hash_iter_destruir(iter);
+    ok = ok && iterados == hash_cantidad(hash);
+
+    hash_destruir(hash);
+    return ok;
+}
+
+static void prueba_hash_redimension_incremental(size_t largo)
+{
+    claves_opciones_t prueba = { largo, crear_claves_prueba(largo, LARGO_CLAVE_OPCIONES) };
+    bool ok = probar_todas_las_opciones(redimensionar_mientras_se_usa, &prueba);
+    print_test("Prueba hash redimension incremental", ok);
+
+    free(prueba.claves);
+}
+
+static size_t capacidad_de(const hash_t* hash)
+{
+    hash_estadisticas_t estadisticas;
+    hash_estadisticas(hash, &estadisticas);
+    return estadisticas.capacidad;
+}
+
+static bool achicar_y_reservar(const hash_opciones_t* opciones, void* extra)
+{
+    claves_opciones_t* prueba = extra;
+    size_t largo = prueba->largo;
+    char (*claves)[LARGO_CLAVE_OPCIONES] = prueba->claves;
+    hash_t* hash = hash_crear_opciones(NULL, opciones);
+
+    /* Reservar agranda la tabla de una vez, y guardar no la cambia */
+    size_t inicial = capacidad_de(hash);
+    bool ok = hash_reservar(hash, largo);
+    size_t reservada = capacidad_de(hash);
+    ok = ok && reservada > inicial && reservada > largo;
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_guardar(hash, claves[i], claves[i]);
+    }
+    ok = ok && capacidad_de(hash) == reservada;
+
+    /* Borrar casi todo no achica por debajo de lo reservado */
+    for (size_t i = 0; i < largo && ok; i++) {
+        if (i % 100) ok = hash_borrar(hash, claves[i]) == claves[i];
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_obtener(hash, claves[i]) == (i % 100 ? NULL : claves[i]);
+    }
+    ok = ok && hash_cantidad(hash) == (largo + 99) / 100 && capacidad_de(hash) == reservada;
+
+    /* Compactar achica sin perder elementos y la tabla puede volver a crecer */
+    ok = ok && hash_compactar(hash) && capacidad_de(hash) < reservada;
+    for (size_t i = 0; i < largo && ok; i += 100) {
+        ok = hash_obtener(hash, claves[i]) == claves[i];
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_guardar(hash, claves[i], claves[i]);
+    }
+    ok = ok && hash_cantidad(hash) == largo;
+
+    /* Sin reserva, borrar casi todo sí achica la tabla */
+    size_t llena = capacidad_de(hash);
+    for (size_t i = 0; i < largo && ok; i++) {
+        if (i % 100) ok = hash_borrar(hash, claves[i]) == claves[i];
+    }
+    ok = ok && capacidad_de(hash) < llena;
+    for (size_t i = 0; i < largo && ok; i++) {
+        if (i % 100) ok = hash_guardar(hash, claves[i], claves[i]);
+    }
+
+    size_t iterados = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) iterados++;
+    hash_iter_destruir(iter);
+    ok = ok && iterados == largo;
+
+    hash_destruir(hash);
+    return ok;
+}
+
+static void prueba_hash_achicar_y_reservar(size_t largo)
+{
+    claves_opciones_t prueba = { largo, crear_claves_prueba(largo, LARGO_CLAVE_OPCIONES) };
+    char (*claves)[LARGO_CLAVE_OPCIONES] = prueba.claves;
+    bool ok = probar_todas_las_opciones(achicar_y_reservar, &prueba);
+    print_test("Prueba hash achicar, reservar y compactar", ok);
+
+    /* Una cantidad que no entra en ninguna tabla falla enseguida */
+    hash_t* hash = hash_crear(NULL);
+    ok = hash_guardar(hash, claves[0], NULL) && !hash_reservar(hash, SIZE_MAX);
+    ok = ok && !hash_reservar(hash, SIZE_MAX / 2) && hash_pertenece(hash, claves[0]) && hash_cantidad(hash) == 1;
+    print_test("Prueba hash reservar mas de lo posible devuelve false", ok);
+    hash_destruir(hash);
+
+    free(claves);
+}
+
+// Claves de las pruebas con todas las opciones como las recibe hash_cargar.
+typedef struct carga_opciones {
+    claves_opciones_t claves;
+    const char **lista;
+    void **datos;
+} carga_opciones_t;
+
+static bool cargar_en_paralelo(const hash_opciones_t* opciones, void* extra)
+{
+    carga_opciones_t* prueba = extra;
+    size_t largo = prueba->claves.largo;
+    char (*claves)[LARGO_CLAVE_OPCIONES] = prueba->claves.claves;
+    size_t hilos[] = {1, 4};
+
+    bool ok = true;
+    for (size_t h = 0; h < 2 && ok; h++) {
+        hash_t* hash = hash_crear_opciones(NULL, opciones);
+
+        ok = hash_cargar(hash, prueba->lista, prueba->datos, largo, hilos[h]);
+        ok = ok && hash_cantidad(hash) == largo;
+        for (size_t i = 0; i < largo && ok; i++) {
+            ok = hash_obtener(hash, claves[i]) == claves[i];
+        }
+        /* La tabla cargada se sigue pudiendo modificar */
+        for (size_t i = 0; i < largo && ok; i += 2) {
+            ok = hash_borrar(hash, claves[i]) == claves[i];
+        }
+        for (size_t i = 0; i < largo && ok; i++) {
+            ok = hash_obtener(hash, claves[i]) == (i % 2 ? claves[i] : NULL);
+        }
+        /* Con elementos ya guardados las guarda de a una */
+        ok = ok && hash_cargar(hash, prueba->lista, prueba->datos, largo / 2, hilos[h]);
+        ok = ok && hash_cantidad(hash) == largo / 2 + (largo / 2 + 1) / 2;
+        hash_destruir(hash);
+    }
+    return ok;
+}
+
+static void prueba_hash_cargar(size_t largo)
+{
+    carga_opciones_t prueba = {
+        { largo, crear_claves_prueba(largo, LARGO_CLAVE_OPCIONES) },
+        malloc(largo * sizeof(char *)), malloc(largo * sizeof(void *))
+    };
+    for (unsigned i = 0; i < largo; i++) {
+        prueba.lista[i] = prueba.claves.claves[i];
+        prueba.datos[i] = prueba.claves.claves[i];
+    }
+
+    /* DJB2 con claves secuenciales forma grupos que cruzan de una región a otra */
+    bool ok = probar_todas_las_opciones(cargar_en_paralelo, &prueba);
+    print_test("Prueba hash cargar en paralelo con todas las opciones", ok);
+
+    free(prueba.datos);
+    free(prueba.lista);
+    free(prueba.claves.claves);
+}
+
+static const void *entero_a_bytes(const void *dato, size_t *largo)
+{
+    *largo = sizeof(size_t);
+    return dato;
+}
+
+// Claves de las pruebas con todas las opciones y el archivo donde se guardan.
+typedef struct archivo_opciones {
+    claves_opciones_t claves;
+    const char *ruta;
+} archivo_opciones_t;
+
+static bool guardar_y_mapear(const hash_opciones_t* opciones, void* extra)
+{
+    archivo_opciones_t* prueba = extra;
+    size_t largo = prueba->claves.largo;
+    char (*claves)[LARGO_CLAVE_OPCIONES] = prueba->claves.claves;
+    const char *ruta = prueba->ruta;
+
+    hash_t* hash = hash_crear_opciones(NULL, opciones);
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_guardar(hash, claves[i], i % 7 ? claves[i] : NULL);
+    }
+    ok = ok && hash_guardar_archivo(hash, ruta, NULL);
+    hash_destruir(hash);
+
+    hash = ok ? hash_cargar_mmap(ruta) : NULL;
+    ok = hash && hash_cantidad(hash) == largo;
+    for (size_t i = 0; i < largo && ok; i++) {
+        char* dato = hash_obtener(hash, claves[i]);
+        ok = hash_pertenece(hash, claves[i]) && (i % 7 ? dato && strcmp(dato, claves[i]) == 0 : !dato);
+    }
+    ok = ok && !hash_pertenece(hash, "no esta");
+
+    size_t iterados = 0;
+    hash_iter_t* iter = ok ? hash_iter_crear(hash) : NULL;
+    for (; iter && !hash_iter_al_final(iter) && ok; hash_iter_avanzar(iter), iterados++) {
+        ok = hash_pertenece(hash, hash_iter_ver_actual(iter));
+    }
+    hash_iter_destruir(iter);
+    ok = ok && iterados == largo;
+
+    /* Es de solo lectura */
+    ok = ok && !hash_guardar(hash, "nueva", NULL) && !hash_borrar(hash, claves[1]);
+    ok = ok && hash_cantidad(hash) == largo;
+    if (hash) hash_destruir(hash);
+    return ok;
+}
+
+static void prueba_hash_archivo_mmap(size_t largo)
+{
+    char (*claves)[LARGO_CLAVE_OPCIONES] = crear_claves_prueba(largo, LARGO_CLAVE_OPCIONES);
+    size_t *numeros = malloc(largo * sizeof(size_t));
+    for (unsigned i = 0; i < largo; i++) {
+        numeros[i] = i;
+    }
+    char ruta[] = "/tmp/hash_pruebas_XXXXXX";
+    int descriptor = mkstemp(ruta);
+    if (descriptor >= 0) close(descriptor);
+
+    /* La redimensión incremental deja elementos en las dos tablas al guardar */
+    archivo_opciones_t prueba = { { largo, claves }, ruta };
+    bool ok = descriptor >= 0 && probar_todas_las_opciones(guardar_y_mapear, &prueba);
+    print_test("Prueba hash guardar archivo y mapearlo con todas las opciones", ok);
+
+    /* Datos que no son cadenas */
+    hash_t* hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_guardar(hash, claves[i], &numeros[i]);
+    }
+    ok = ok && hash_guardar_archivo(hash, ruta, entero_a_bytes);
+    hash_destruir(hash);
+    hash = ok ? hash_cargar_mmap(ruta) : NULL;
+    ok = hash != NULL;
+    for (size_t i = 0; i < largo && ok; i++) {
+        size_t* dato = hash_obtener(hash, claves[i]);
+        ok = dato && *dato == i;
+    }
+    print_test("Prueba hash guardar archivo con datos binarios", ok);
+
+    /* Guardar otra vez en la misma ruta no afecta al hash que la tiene mapeada */
+    hash_t* nuevo = hash_crear(NULL);
+    ok = ok && hash_guardar(nuevo, "nueva", NULL) && hash_guardar_archivo(nuevo, ruta, NULL);
+    hash_destruir(nuevo);
+    for (size_t i = 0; i < largo && ok; i++) {
+        size_t* dato = hash_obtener(hash, claves[i]);
+        ok = dato && *dato == i;
+    }
+    if (hash) hash_destruir(hash);
+    hash = ok ? hash_cargar_mmap(ruta) : NULL;
+    ok = hash && hash_cantidad(hash) == 1 && hash_pertenece(hash, "nueva");
+    if (hash) hash_destruir(hash);
+    print_test("Prueba hash guardar archivo sobre uno mapeado lo reemplaza sin tocarlo", ok);
+
+    remove(ruta);
+    print_test("Prueba hash mapear archivo que no existe es NULL", !hash_cargar_mmap(ruta));
+
+    free(numeros);
+    free(claves);
+}
+
+// Lee o escribe 'largo' bytes del archivo a partir de 'desde'.
+static bool leer_archivo(const char* ruta, long desde, void* bytes, size_t largo)
+{
+    FILE* archivo = fopen(ruta, "rb");
+    bool ok = archivo && fseek(archivo, desde, SEEK_SET) == 0 && fread(bytes, 1, largo, archivo) == largo;
+    if (archivo) fclose(archivo);
+    return ok;
+}
+
+static bool escribir_archivo(const char* ruta, long desde, const void* bytes, size_t largo)
+{
+    FILE* archivo = fopen(ruta, "r+b");
+    bool ok = archivo && fseek(archivo, desde, SEEK_SET) == 0 && fwrite(bytes, 1, largo, archivo) == largo;
+    if (archivo) ok = fclose(archivo) == 0 && ok;
+    return ok;
+}
+
+/* Archivos con una sola clave larga, rotos de distintas formas. Se usa que el
+ * encabezado tiene la capacidad en el byte 24, que la tabla empieza en el 64
+ * y que la clave larga se escribe justo después de los bytes de control.
+ */
+static void prueba_hash_archivo_corrupto()
+{
+    const char* clave = "una clave larga que va fuera del campo";
+    char ruta[] = "/tmp/hash_pruebas_XXXXXX";
+    int descriptor = mkstemp(ruta);
+    if (descriptor >= 0) close(descriptor);
+
+    char contenido[4096];
+    uint64_t capacidad = 0;
+    long lugar_clave = -1;
+    hash_t* hash = hash_crear(NULL);
+    bool ok = descriptor >= 0 && hash_guardar(hash, clave, NULL) && hash_guardar_archivo(hash, ruta, NULL);
+    hash_destruir(hash);
+    ok = ok && leer_archivo(ruta, 0, contenido, 64) && leer_archivo(ruta, 24, &capacidad, sizeof(capacidad));
+    for (long i = 64; ok && lugar_clave < 0 && leer_archivo(ruta, i, contenido, strlen(clave)); i++) {
+        if (memcmp(contenido, clave, strlen(clave)) == 0) lugar_clave = i;
+    }
+    ok = ok && lugar_clave > 0 && capacidad > 0 && capacidad < sizeof(contenido);
+    print_test("Prueba hash archivo corrupto, el original se puede mapear", ok && (hash = hash_cargar_mmap(ruta)));
+    if (ok && hash) hash_destruir(hash);
+
+    /* Capacidad que desborda al multiplicarla por el tamaño de un campo */
+    uint64_t enorme = 1ULL << 60;
+    ok = ok && escribir_archivo(ruta, 24, &enorme, sizeof(enorme));
+    print_test("Prueba hash archivo con capacidad enorme es NULL", ok && !hash_cargar_mmap(ruta));
+    ok = ok && escribir_archivo(ruta, 24, &capacidad, sizeof(capacidad));
+
+    /* Sin ningún VACIO las búsquedas fallidas no terminarían */
+    long inicio_control = lugar_clave - (long) capacidad;
+    ok = ok && leer_archivo(ruta, inicio_control, contenido, capacidad);
+    char llenos[4096] = { 0 };
+    ok = ok && escribir_archivo(ruta, inicio_control, llenos, capacidad);
+    print_test("Prueba hash archivo sin posiciones vacias es NULL", ok && !hash_cargar_mmap(ruta));
+    ok = ok && escribir_archivo(ruta, inicio_control, contenido, capacidad);
+
+    /* El campo guarda el desplazamiento de la clave: se lo manda fuera del archivo */
+    long campo_clave = -1;
+    for (long i = 64; ok && campo_clave < 0 && i + 8 <= inicio_control; i += 8) {
+        uint64_t valor;
+        ok = leer_archivo(ruta, i, &valor, sizeof(valor));
+        if (valor == (uint64_t) lugar_clave) campo_clave = i;
+    }
+    uint64_t afuera = 1ULL << 40;
+    ok = ok && campo_clave > 0 && escribir_archivo(ruta, campo_clave, &afuera, sizeof(afuera));
+    print_test("Prueba hash archivo con clave fuera del archivo es NULL", ok && !hash_cargar_mmap(ruta));
+
+    remove(ruta);
+}
+
+typedef struct recorrido_prueba {
+    size_t visitados;
+    size_t limite;
+    bool ok;
+} recorrido_prueba_t;
+
+static bool visitar_prueba(const char* clave, size_t largo, void* dato, void* extra)
+{
+    recorrido_prueba_t* recorrido = extra;
+    recorrido->ok = recorrido->ok && strlen(clave) == largo && strcmp(dato, clave) == 0;
+    recorrido->visitados++;
+    return recorrido->visitados < recorrido->limite;
+}
+
+static void prueba_hash_cursor_y_recorrer(size_t largo)
+{
+    /* Con redimensión incremental, parte de los elementos siguen en la tabla vieja */
+    hash_opciones_t opciones = { .redimension_incremental = true };
+    hash_t* hash = hash_crear_opciones(NULL, &opciones);
+
+    hash_cursor_t cursor;
+    hash_cursor_iniciar(&cursor, hash);
+    print_test("Prueba hash cursor en hash vacio no tiene siguiente", !hash_cursor_siguiente(&cursor, NULL, NULL, NULL));
+
+    const size_t largo_clave = 24;
+    char (*claves)[largo_clave] = crear_claves_prueba(largo, largo_clave);
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        ok = hash_guardar(hash, claves[i], claves[i]);
+    }
+
+    const char* clave;
+    size_t largo_actual;
+    void* dato;
+    size_t visitados = 0;
+    hash_cursor_iniciar(&cursor, hash);
+    while (ok && hash_cursor_siguiente(&cursor, &clave, &largo_actual, &dato)) {
+        ok = strlen(clave) == largo_actual && strcmp(dato, clave) == 0 && hash_obtener(hash, clave) == dato;
+        visitados++;
+    }
+    ok = ok && visitados == largo && !hash_cursor_siguiente(&cursor, &clave, NULL, NULL);
+    print_test("Prueba hash cursor recorre cada elemento una vez con su dato", ok);
+
+    recorrido_prueba_t recorrido = { .limite = SIZE_MAX, .ok = true };
+    hash_recorrer(hash, visitar_prueba, &recorrido);
+    print_test("Prueba hash recorrer visita todos los elementos", recorrido.ok && recorrido.visitados == largo);
+
+    recorrido = (recorrido_prueba_t) { .limite = 10, .ok = true };
+    hash_recorrer(hash, visitar_prueba, &recorrido);
+    print_test("Prueba hash recorrer se corta cuando visitar devuelve false", recorrido.ok && recorrido.visitados == 10);
+
+    free(claves);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_iterar_esparcido()
+{
+    /* Pocos elementos en una tabla grande: el recorrido saltea bloques enteros vacíos */
+    hash_t* hash = hash_crear(NULL);
+    bool ok = hash_reservar(hash, 100000);
+
+    const size_t largo = 300, largo_clave = 24;
+    char (*claves)[largo_clave] = crear_claves_prueba(largo, largo_clave);
+    for (unsigned i = 0; i < largo && ok; i++) {
+        ok = hash_guardar(hash, claves[i], claves[i]);
+    }
+    for (size_t i = 0; i < largo && ok; i += 3) {
+        ok = hash_borrar(hash, claves[i]) == claves[i];
+    }
+
+    size_t iterados = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter) && ok; hash_iter_avanzar(iter), iterados++) {
+        ok = hash_pertenece(hash, hash_iter_ver_actual(iter));
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash iterar tabla esparcida", ok && iterados == hash_cantidad(hash));
+
+    hash_cursor_t cursor;
+    hash_cursor_iniciar(&cursor, hash);
+    const char* clave;
+    void* dato;
+    size_t visitados = 0;
+    while (ok && hash_cursor_siguiente(&cursor, &clave, NULL, &dato)) {
+        ok = strcmp(clave, dato) == 0;
+        visitados++;
+    }
+    recorrido_prueba_t recorrido = { .limite = SIZE_MAX, .ok = true };
+    hash_recorrer(hash, visitar_prueba, &recorrido);
+    print_test("Prueba hash cursor y recorrer en tabla esparcida", ok && visitados == largo - largo / 3 &&
+               recorrido.ok && recorrido.visitados == visitados);
+
+    free(claves);
+    hash_destruir(hash);
+}
+
+typedef struct punto_prueba {
+    int x, y;
+} punto_prueba_t;
+
+static unsigned long hashear_punto(const void* clave)
+{
+    const punto_prueba_t* punto = clave;
+    return (unsigned long) punto->x * 31 + (unsigned long) punto->y;
+}
+
+static bool puntos_iguales(const void* a, const void* b)
+{
+    const punto_prueba_t *p = a, *q = b;
+    return p->x == q->x && p->y == q->y;
+}
+
+static void* copiar_punto(const void* clave)
+{
+    punto_prueba_t* copia = malloc(sizeof(punto_prueba_t));
+    if (copia) *copia = *(const punto_prueba_t*) clave;
+    return copia;
+}
+
+static void prueba_hash_claves_propias(size_t largo)
+{
+    hash_tipo_clave_t tipo = { hashear_punto, puntos_iguales, copiar_punto, free };
+    hash_motor_t motores[] = {HASH_MOTOR_LINEAL, HASH_MOTOR_ROBIN_HOOD};
+
+    /* Las claves se buscan con otra variable de igual contenido, y las copias
+     * se liberan al borrar y al destruir (ASan avisa si no) */
+    bool ok = true;
+    for (size_t m = 0; m < 2; m++) {
+        hash_opciones_t opciones = { .motor = motores[m], .tipo_clave = &tipo, .redimension_incremental = m == 1 };
+        hash_t* hash = hash_crear_opciones(NULL, &opciones);
+        for (size_t i = 0; i < largo && ok; i++) {
+            punto_prueba_t punto = { (int) i, -(int) i };
+            ok = hash_guardar_clave(hash, &punto, (void*) (i + 1));
+        }
+        ok = ok && hash_cantidad(hash) == largo;
+        for (size_t i = 0; i < largo && ok; i += 2) {
+            punto_prueba_t punto = { (int) i, -(int) i };
+            ok = hash_borrar_clave(hash, &punto) == (void*) (i + 1);
+        }
+        for (size_t i = 0; i < largo && ok; i++) {
+            punto_prueba_t punto = { (int) i, -(int) i };
+            ok = hash_obtener_clave(hash, &punto) == (i % 2 ? (void*) (i + 1) : NULL) &&
+                 hash_pertenece_clave(hash, &punto) == (i % 2 == 1);
+        }
+
+        hash_cursor_t cursor;
+        hash_cursor_iniciar(&cursor, hash);
+        const char* clave;
+        size_t largo_clave;
+        void* dato;
+        size_t visitados = 0;
+        while (ok && hash_cursor_siguiente(&cursor, &clave, &largo_clave, &dato)) {
+            const punto_prueba_t* punto = (const punto_prueba_t*) clave;
+            ok = largo_clave == 0 && dato == (void*) (size_t) (punto->x + 1) && punto->y == -punto->x;
+            visitados++;
+        }
+        ok = ok && visitados == largo / 2;
+        hash_destruir(hash);
+    }
+    print_test("Prueba hash claves propias con copia en los dos motores", ok);
+
+    /* Las funciones de cadenas también reciben claves del tipo propio, sin
+     * leerlas como cadenas: el punto no tiene ningún '\0' y ocupa justo su
+     * memoria, así que un strlen se saldría (ASan avisa) */
+    hash_opciones_t con_copia = { .tipo_clave = &tipo };
+    hash_t* hash = hash_crear_opciones(NULL, &con_copia);
+    punto_prueba_t* punto = malloc(sizeof(punto_prueba_t));
+    *punto = (punto_prueba_t) { 0x01010101, 0x02020202 };
+    ok = hash_guardar(hash, (const char*) punto, "dato") && hash_pertenece(hash, (const char*) punto);
+    ok = ok && strcmp(hash_obtener(hash, (const char*) punto), "dato") == 0;
+    ok = ok && hash_borrar(hash, (const char*) punto) && hash_cantidad(hash) == 0;
+    free(punto);
+    hash_destruir(hash);
+    print_test("Prueba hash claves propias con las funciones de cadenas", ok);
+
+    hash_opciones_t con_arena = { .tipo_clave = &tipo, .claves_en_arena = true };
+    print_test("Prueba hash claves propias con arena no crea el hash", !hash_crear_opciones(NULL, &con_arena));
+
+    /* Sin copiar, el hash guarda los punteros recibidos */
+    hash_tipo_clave_t sin_copia = { hashear_punto, puntos_iguales, NULL, NULL };
+    hash_opciones_t opciones = { .tipo_clave = &sin_copia };
+    hash = hash_crear_opciones(NULL, &opciones);
+    punto_prueba_t puntos[] = { {1, 2}, {2, 1}, {0, 0} };
+    const char* claves[] = { (const char*) &puntos[0], (const char*) &puntos[1], (const char*) &puntos[2] };
+    void* datos[] = { "a", "b", "c" };
+    ok = hash_cargar(hash, claves, datos, 3, 0) && hash_cantidad(hash) == 3;
+    punto_prueba_t buscado = {2, 1};
+    ok = ok && hash_obtener_clave(hash, &buscado) == datos[1];
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter) && ok; hash_iter_avanzar(iter)) {
+        const char* actual = hash_iter_ver_actual(iter);
+        ok = actual == claves[0] || actual == claves[1] || actual == claves[2];
+    }
+    hash_iter_destruir(iter);
+    ok = ok && !hash_guardar_archivo(hash, "/nonexistent", NULL);
+    print_test("Prueba hash claves propias sin copia guarda los punteros", ok);
+    hash_destruir(hash);
+}
+
+static size_t sumar_histograma(const size_t histograma[HASH_BUCKETS_ESTADISTICAS])
+{
+    size_t total = 0;
+    for (size_t i = 0; i < HASH_BUCKETS_ESTADISTICAS; i++) total += histograma[i];
+    return total;
+}
+
+static void prueba_hash_estadisticas(size_t largo)
+{
+    hash_t* hash = hash_crear(NULL);
+
+    const size_t largo_clave = 24;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    bool ok = true;
+    for (unsigned i = 0; i < largo && ok; i++) {
+        sprintf(claves[i], "%08d", i);
+        ok = hash_guardar(hash, claves[i], claves[i]);
+    }
+    for (size_t i = 0; i < largo && ok; i += 10) {
+        ok = hash_borrar(hash, claves[i]) == claves[i];
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        ok = hash_obtener(hash, claves[i]) == (i % 10 ? claves[i] : NULL);
+    }
+
+    hash_estadisticas_t estadisticas;
+    hash_estadisticas(hash, &estadisticas);
+    ok = ok && estadisticas.cantidad == hash_cantidad(hash) && estadisticas.borrados == (largo + 9) / 10;
+    ok = ok && estadisticas.carga < 0.7 && estadisticas.proporcion_borrados > 0;
+    print_test("Prueba hash estadisticas del estado de la tabla", ok);
+
+    /* Cada elemento tiene una distancia, y las rachas cubren elementos y borrados */
+    size_t en_rachas = 0;
+    for (size_t i = 0; i < HASH_BUCKETS_ESTADISTICAS; i++) {
+        size_t desde = i == 0 ? 0 : (size_t) 1 << (i - 1);
+        en_rachas += estadisticas.rachas[i] * desde;
+    }
+    ok = sumar_histograma(estadisticas.distancias) == estadisticas.cantidad &&
+         en_rachas <= estadisticas.cantidad + estadisticas.borrados &&
+         estadisticas.racha_maxima > estadisticas.distancia_maxima;
+    print_test("Prueba hash estadisticas histogramas de distancias y rachas", ok);
+
+    /* Los contadores dependen de cómo se compiló hash.c */
+    if (estadisticas.contadores) {
+        ok = estadisticas.aciertos == largo - (largo + 9) / 10 && estadisticas.fallos == (largo + 9) / 10 &&
+             sumar_histograma(estadisticas.sondeos) == largo && estadisticas.redimensiones > 0 &&
+             estadisticas.bytes_movidos > 0;
+    } else {
+        ok = estadisticas.aciertos == 0 && estadisticas.redimensiones == 0;
+    }
+    print_test("Prueba hash estadisticas contadores de busquedas y redimensiones", ok);
+
+    FILE* salida = fopen("/dev/null", "w");
+    if (salida) {
+        hash_estadisticas_imprimir(hash, salida);
+        fclose(salida);
+    }
+
+    free(claves);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_opciones_de_carga(size_t largo)
+{
+    hash_opciones_t invalidas[] = {
+        { .carga_maxima = 1 }, { .carga_maxima = -0.5 }, { .factor_crecimiento = 3 },
+        { .carga_maxima = 0.8, .carga_minima = 0.5 }, { .capacidad_inicial = SIZE_MAX },
+        { .capacidad_inicial = SIZE_MAX / 2 + 2 },
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(invalidas) / sizeof(invalidas[0]); i++) {
+        hash_t* hash = hash_crear_opciones(NULL, &invalidas[i]);
+        ok = ok && !hash;
+        if (hash) hash_destruir(hash);
+    }
+    print_test("Prueba hash opciones de carga invalidas no crean el hash", ok);
+
+    /* Crecer más allá de la mayor capacidad posible falla sin tocar el hash */
+    hash_opciones_t enorme = { .capacidad_inicial = 2, .factor_crecimiento = (size_t) 1 << (sizeof(size_t) * 8 - 2) };
+    hash_t* hash = hash_crear_opciones(NULL, &enorme);
+    ok = hash && hash_guardar(hash, "uno", NULL) && !hash_guardar(hash, "dos", NULL);
+    ok = ok && hash_cantidad(hash) == 1 && hash_pertenece(hash, "uno") && !hash_pertenece(hash, "dos");
+    if (hash) hash_destruir(hash);
+    print_test("Prueba hash crecer mas alla de la capacidad maxima falla", ok);
+
+    const size_t largo_clave = 24;
+    char (*claves)[largo_clave] = crear_claves_prueba(largo, largo_clave);
+
+    /* Tablas chicas que crecen y vuelven a su capacidad inicial, una grande
+     * que no cambia, y cargas altas con crecimiento de a 4 */
+    hash_opciones_t opciones[] = {
+        { .capacidad_inicial = 2 },
+        { .capacidad_inicial = 3, .motor = HASH_MOTOR_ROBIN_HOOD, .carga_maxima = 0.95 },
+        { .capacidad_inicial = largo * 2 },
+        { .carga_maxima = 0.95, .factor_crecimiento = 4 },
+        { .carga_maxima = 0.5, .factor_crecimiento = 4, .redimension_incremental = true },
+    };
+    size_t iniciales[] = { 2, 4, 1, 32, 32 };
+    while (iniciales[2] < largo * 2) iniciales[2] *= 2;
+    bool todas = true;
+    for (size_t o = 0; o < sizeof(opciones) / sizeof(opciones[0]); o++) {
+        hash_t* hash = hash_crear_opciones(NULL, &opciones[o]);
+        ok = hash && capacidad_de(hash) == iniciales[o];
+        for (size_t i = 0; i < largo && ok; i++) ok = hash_guardar(hash, claves[i], claves[i]);
+        for (size_t i = 0; i < largo && ok; i++) ok = hash_obtener(hash, claves[i]) == claves[i];
+
+        hash_estadisticas_t estadisticas = { 0 };
+        if (hash) hash_estadisticas(hash, &estadisticas);
+        double maxima = opciones[o].carga_maxima ? opciones[o].carga_maxima : 0.7;
+        ok = ok && estadisticas.carga <= maxima && estadisticas.capacidad >= iniciales[o];
+        if (opciones[o].factor_crecimiento == 4) {
+            size_t crecimiento = estadisticas.capacidad / iniciales[o];
+            ok = ok && (crecimiento & 0x5555555555555555ULL) == crecimiento;
+        }
+
+        /* Con redimensión incremental cada achique termina de migrar en operaciones posteriores */
+        for (size_t i = 0; i < largo && ok; i++) ok = hash_borrar(hash, claves[i]) == claves[i];
+        for (size_t i = 0; i < largo && ok; i++) {
+            ok = hash_guardar(hash, "x", NULL) && hash_borrar(hash, "x") == NULL;
+        }
+        ok = ok && capacidad_de(hash) == iniciales[o];
+        if (hash) hash_destruir(hash);
+        todas = todas && ok;
+    }
+    print_test("Prueba hash opciones de carga crecer y achicar", todas);
+
+    free(claves);
+}
+
+#define LARGO_CLAVE_SONDEO 16
+
+/* Llena claves con 'cantidad' claves distintas cuya posición original en
+ * una tabla de 'capacidad' posiciones es 'origen'. */
+static void claves_con_origen(const hash_t* hash, size_t capacidad, size_t origen,
+                              char claves[][LARGO_CLAVE_SONDEO], size_t cantidad)
+{
+    size_t encontradas = 0;
+    for (unsigned i = 0; encontradas < cantidad; i++) {
+        snprintf(claves[encontradas], LARGO_CLAVE_SONDEO, "s%u", i);
+        if ((hash_calcular(hash, claves[encontradas], strlen(claves[encontradas])) & (capacidad - 1)) == origen) {
+            encontradas++;
+        }
+    }
+}
+
+/* Claves que empiezan cerca del final de la tabla siguen desde el principio,
+ * tanto avanzando de a una posición como de a grupos de 16 */
+static void prueba_hash_sondeo_da_la_vuelta()
+{
+    hash_motor_t motores[] = {HASH_MOTOR_LINEAL, HASH_MOTOR_ROBIN_HOOD};
+    size_t origenes[] = {62, 48};
+    const size_t capacidad = 64, cantidad = 20;
+
+    bool ok = true;
+    for (size_t m = 0; m < 2; m++) {
+        for (size_t o = 0; o < 2; o++) {
+            hash_opciones_t opciones = { .motor = motores[m], .capacidad_inicial = capacidad };
+            hash_t* hash = hash_crear_opciones(NULL, &opciones);
+            char claves[cantidad + 1][LARGO_CLAVE_SONDEO];
+            claves_con_origen(hash, capacidad, origenes[o], claves, cantidad + 1);
+
+            /* Cada clave queda justo después de la anterior, pasando por la posición 0 */
+            for (size_t i = 0; i < cantidad && ok; i++) ok = hash_guardar(hash, claves[i], claves[i]);
+            ok = ok && capacidad_de(hash) == capacidad;
+            for (size_t i = 0; i < cantidad && ok; i++) {
+                ok = hash_obtener(hash, claves[i]) == claves[i] && hash_largo_sondeo(hash, claves[i]) == i + 1;
+            }
+            ok = ok && !hash_pertenece(hash, claves[cantidad]) && hash_largo_sondeo(hash, claves[cantidad]) == cantidad + 1;
+
+            /* Borrar una clave de antes del final no corta el sondeo de las que siguen */
+            ok = ok && hash_borrar(hash, claves[1]) == claves[1];
+            for (size_t i = 2; i < cantidad && ok; i++) ok = hash_obtener(hash, claves[i]) == claves[i];
+            ok = ok && !hash_pertenece(hash, claves[1]) && !hash_pertenece(hash, claves[cantidad]);
+            hash_destruir(hash);
+        }
+    }
+    print_test("Prueba hash sondeo da la vuelta al final de la tabla", ok);
+}
+
+/* Un grupo de 16 posiciones todas borradas no corta el sondeo, y la primera
+ * de ellas se reutiliza */
+static void prueba_hash_grupo_de_borrados()
+{
+    const size_t capacidad = 64, cantidad = 20, grupo = 16;
+    hash_opciones_t opciones = { .capacidad_inicial = capacidad };
+    hash_t* hash = hash_crear_opciones(NULL, &opciones);
+    char claves[cantidad + 2][LARGO_CLAVE_SONDEO];
+    claves_con_origen(hash, capacidad, 0, claves, cantidad + 2);
+
+    bool ok = true;
+    for (size_t i = 0; i < cantidad && ok; i++) ok = hash_guardar(hash, claves[i], claves[i]);
+    for (size_t i = 0; i < grupo && ok; i++) ok = hash_borrar(hash, claves[i]) == claves[i];
+    ok = ok && capacidad_de(hash) == capacidad && hash_cantidad(hash) == cantidad - grupo;
+    print_test("Prueba hash grupo de borrados borrar las primeras 16 claves", ok);
+
+    for (size_t i = grupo; i < cantidad && ok; i++) {
+        ok = hash_obtener(hash, claves[i]) == claves[i] && hash_largo_sondeo(hash, claves[i]) == i + 1;
+    }
+    print_test("Prueba hash grupo de borrados las claves de despues se encuentran", ok);
+    print_test("Prueba hash grupo de borrados una clave que no esta recorre todo",
+               !hash_pertenece(hash, claves[cantidad]) && hash_largo_sondeo(hash, claves[cantidad]) == cantidad + 1);
+
+    ok = hash_guardar(hash, claves[cantidad + 1], claves[cantidad + 1]);
+    print_test("Prueba hash grupo de borrados guardar reutiliza el primer borrado",
+               ok && hash_largo_sondeo(hash, claves[cantidad + 1]) == 1);
+    for (size_t i = 0; i < grupo && ok; i++) ok = !hash_pertenece(hash, claves[i]);
+    print_test("Prueba hash grupo de borrados las claves borradas no vuelven", ok);
+
+    hash_destruir(hash);
+}
+
+/* Con más claves en la misma posición original que etiquetas de 7 bits,
+ * al menos dos comparten etiqueta y se distinguen por la clave */
+static void prueba_hash_etiquetas_repetidas()
+{
+    hash_motor_t motores[] = {HASH_MOTOR_LINEAL, HASH_MOTOR_ROBIN_HOOD};
+    const size_t capacidad = 256, cantidad = 130;
+
+    bool ok = true;
+    for (size_t m = 0; m < 2; m++) {
+        hash_opciones_t opciones = { .motor = motores[m], .capacidad_inicial = capacidad, .carga_maxima = 0.9 };
+        hash_t* hash = hash_crear_opciones(NULL, &opciones);
+        char claves[cantidad][LARGO_CLAVE_SONDEO];
+        claves_con_origen(hash, capacidad, 0, claves, cantidad);
+
+        for (size_t i = 0; i < cantidad && ok; i++) ok = hash_guardar(hash, claves[i], claves[i]);
+        ok = ok && capacidad_de(hash) == capacidad;
+        for (size_t i = 0; i < cantidad && ok; i++) ok = hash_obtener(hash, claves[i]) == claves[i];
+        for (size_t i = 0; i < cantidad && ok; i += 2) ok = hash_borrar(hash, claves[i]) == claves[i];
+        for (size_t i = 0; i < cantidad && ok; i++) {
+            ok = i % 2 ? hash_obtener(hash, claves[i]) == claves[i] : !hash_pertenece(hash, claves[i]);
+        }
+        hash_destruir(hash);
+    }
+    print_test("Prueba hash etiquetas repetidas en la misma posicion", ok);
+}
+
+/* Con carga máxima cerca de 1 la tabla se llena hasta dejar una sola
+ * posición vacía, donde terminan las búsquedas de claves que no están */
+static void prueba_hash_un_solo_vacio()
+{
+    hash_motor_t motores[] = {HASH_MOTOR_LINEAL, HASH_MOTOR_ROBIN_HOOD};
+    const size_t capacidad = 64, largo_clave = 24;
+    char (*claves)[largo_clave] = crear_claves_prueba(capacidad + 1, largo_clave);
+
+    bool ok = true;
+    for (size_t m = 0; m < 2; m++) {
+        hash_opciones_t opciones = { .motor = motores[m], .capacidad_inicial = capacidad, .carga_maxima = 0.99 };
+        hash_t* hash = hash_crear_opciones(NULL, &opciones);
+        for (size_t i = 0; i < capacidad - 1 && ok; i++) ok = hash_guardar(hash, claves[i], claves[i]);
+        ok = ok && capacidad_de(hash) == capacidad && hash_cantidad(hash) == capacidad - 1;
+        for (size_t i = 0; i < capacidad - 1 && ok; i++) {
+            ok = hash_obtener(hash, claves[i]) == claves[i] && hash_largo_sondeo(hash, claves[i]) < capacidad;
+        }
+        for (size_t i = capacidad - 1; i <= capacidad && ok; i++) {
+            ok = !hash_pertenece(hash, claves[i]) && hash_largo_sondeo(hash, claves[i]) <= capacidad;
+        }
+
+        /* La siguiente clave ya no entra sin dejar la tabla sin vacíos, así que crece */
+        ok = ok && hash_guardar(hash, claves[capacidad - 1], claves[capacidad - 1]) && capacidad_de(hash) > capacidad;
+        for (size_t i = 0; i < capacidad && ok; i++) ok = hash_obtener(hash, claves[i]) == claves[i];
+        hash_destruir(hash);
+    }
+    print_test("Prueba hash tabla con una sola posicion vacia", ok);
+
+    free(claves);
+}
+
 static ssize_t buscar(const char* clave, char* claves[], size_t largo)
 {
     for (size_t i = 0; i < largo; i++) {
@@ -406,9 +1562,31 @@ void pruebas_hash_catedra()
     prueba_hash_reemplazar();
     prueba_hash_reemplazar_con_destruir();
     prueba_hash_borrar();
+    prueba_hash_obtener_o_guardar();
     prueba_hash_clave_vacia();
     prueba_hash_valor_null();
+    prueba_hash_claves_de_distinto_largo();
+    prueba_hash_claves_binarias();
     prueba_hash_volumen(5000, true);
+    prueba_hash_borrar_reinsertar_volumen(5000);
+    prueba_hash_robin_hood_volumen(5000);
+    prueba_hash_arena_volumen(5000);
+    prueba_hash_opciones_volumen(5000);
+    prueba_hash_obtener_lote(5000);
+    prueba_hash_redimension_incremental(5000);
+    prueba_hash_achicar_y_reservar(5000);
+    prueba_hash_cargar(5000);
+    prueba_hash_archivo_mmap(5000);
+    prueba_hash_archivo_corrupto();
+    prueba_hash_cursor_y_recorrer(5000);
+    prueba_hash_iterar_esparcido();
+    prueba_hash_claves_propias(5000);
+    prueba_hash_estadisticas(5000);
+    prueba_hash_opciones_de_carga(5000);
+    prueba_hash_sondeo_da_la_vuelta();
+    prueba_hash_grupo_de_borrados();
+    prueba_hash_etiquetas_repetidas();
+    prueba_hash_un_solo_vacio();
     prueba_hash_iterar();
     prueba_hash_iterar_volumen(5000);
 }
@@ -0,0 +1,340 @@
+#include "hash_rcu.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CAPACIDAD_INICIAL 32
+#define VALOR_CARGA 0.7
+#define LARGO_LINEA_CACHE 64
+// Contadores de lectores; cada hilo usa siempre el mismo, así los lectores de
+// hilos distintos casi nunca comparten una línea de caché.
+#define RANURAS_LECTORES 64
+// Cantidad de punteros retirados que se acumulan antes de esperar a los
+// lectores para liberarlos todos juntos.
+#define RETIRADOS_MAX 128
+
+/* Las entradas no cambian una vez publicadas, salvo el dato, que se lee y
+ * escribe de forma atómica. Borrar una clave reemplaza su puntero en la tabla
+ * por BORRADA, así los lectores que estén sondeando siguen de largo.
+ */
+typedef struct entrada{
+  unsigned long hash;
+  void* valor;
+  size_t largo;
+  char clave[];
+} entrada_t;
+
+typedef struct tabla{
+  size_t capacidad;
+  entrada_t* campos[];
+} tabla_t;
+
+static char marca_borrada;
+#define BORRADA ((entrada_t*) &marca_borrada)
+
+typedef struct ranura{
+  unsigned long lectores[2];
+} __attribute__((aligned(LARGO_LINEA_CACHE))) ranura_t;
+
+typedef enum tipo_retiro {
+    RETIRO_TABLA, RETIRO_ENTRADA, RETIRO_DATO
+} tipo_retiro_t;
+
+typedef struct retiro{
+  void* puntero;
+  tipo_retiro_t tipo;
+} retiro_t;
+
+/* Los lectores se anotan en el contador de la época actual (0 o 1) de su
+ * ranura. Para liberar lo retirado, el escritor cambia de época y espera a
+ * que se vacíen los contadores de la anterior: quien entre después ya no
+ * puede llegar a lo que se retiró.
+ */
+struct hash_rcu{
+  ranura_t ranuras[RANURAS_LECTORES];
+  tabla_t* tabla;
+  size_t cantidad;
+  size_t borrados;
+  unsigned epoca;
+  pthread_mutex_t escritura;
+  hash_destruir_dato_t funcion_destruccion;
+  retiro_t* retirados;
+  size_t cantidad_retirados;
+  size_t capacidad_retirados;
+};
+
+static __thread size_t ranura_hilo = SIZE_MAX;
+static size_t siguiente_ranura;
+
+static size_t ranura_propia(void) {
+    if (ranura_hilo == SIZE_MAX) {
+        ranura_hilo = __atomic_fetch_add(&siguiente_ranura, 1, __ATOMIC_RELAXED) % RANURAS_LECTORES;
+    }
+    return ranura_hilo;
+}
+
+static tabla_t *crear_tabla(size_t capacidad) {
+    tabla_t *tabla = calloc(1, sizeof(tabla_t) + capacidad * sizeof(entrada_t*));
+    if (!tabla) return NULL;
+    tabla->capacidad = capacidad;
+    return tabla;
+}
+
+hash_rcu_t *hash_rcu_crear(hash_destruir_dato_t destruir_dato) {
+    void *lugar;
+    if (posix_memalign(&lugar, LARGO_LINEA_CACHE, sizeof(hash_rcu_t)) != 0) return NULL;
+    hash_rcu_t *hash = lugar;
+    memset(hash, 0, sizeof(hash_rcu_t));
+
+    hash->tabla = crear_tabla(CAPACIDAD_INICIAL);
+    if (!hash->tabla || pthread_mutex_init(&hash->escritura, NULL) != 0) {
+        free(hash->tabla);
+        free(hash);
+        return NULL;
+    }
+    hash->funcion_destruccion = destruir_dato;
+    return hash;
+}
+
+/* ******************************************************************
+ *                            LECTURAS
+ * *****************************************************************/
+
+size_t hash_rcu_leer_inicio(hash_rcu_t *hash) {
+    size_t ranura = ranura_propia();
+    while (true) {
+        unsigned epoca = __atomic_load_n(&hash->epoca, __ATOMIC_SEQ_CST) & 1;
+        __atomic_fetch_add(&hash->ranuras[ranura].lectores[epoca], 1, __ATOMIC_SEQ_CST);
+        // Si la época cambió mientras se anotaba, el escritor pudo no verlo.
+        if ((__atomic_load_n(&hash->epoca, __ATOMIC_SEQ_CST) & 1) == epoca) return ranura * 2 + epoca;
+        __atomic_fetch_sub(&hash->ranuras[ranura].lectores[epoca], 1, __ATOMIC_RELEASE);
+    }
+}
+
+void hash_rcu_leer_fin(hash_rcu_t *hash, size_t lectura) {
+    __atomic_fetch_sub(&hash->ranuras[lectura / 2].lectores[lectura % 2], 1, __ATOMIC_RELEASE);
+}
+
+static entrada_t *buscar_entrada(hash_rcu_t *hash, const char *clave) {
+    size_t largo = strlen(clave);
+    unsigned long h = hash_wyhash(clave, largo);
+    tabla_t *tabla = __atomic_load_n(&hash->tabla, __ATOMIC_ACQUIRE);
+    size_t pos = h & (tabla->capacidad - 1);
+
+    while (true) {
+        entrada_t *entrada = __atomic_load_n(&tabla->campos[pos], __ATOMIC_ACQUIRE);
+        if (!entrada) return NULL;
+        if (entrada != BORRADA && entrada->hash == h && entrada->largo == largo &&
+            memcmp(entrada->clave, clave, largo) == 0) {
+            return entrada;
+        }
+        pos = (pos + 1) & (tabla->capacidad - 1);
+    }
+}
+
+void *hash_rcu_obtener(hash_rcu_t *hash, const char *clave) {
+    size_t lectura = hash_rcu_leer_inicio(hash);
+    entrada_t *entrada = buscar_entrada(hash, clave);
+    void *valor = entrada ? __atomic_load_n(&entrada->valor, __ATOMIC_ACQUIRE) : NULL;
+    hash_rcu_leer_fin(hash, lectura);
+    return valor;
+}
+
+bool hash_rcu_pertenece(hash_rcu_t *hash, const char *clave) {
+    size_t lectura = hash_rcu_leer_inicio(hash);
+    bool pertenece = buscar_entrada(hash, clave) != NULL;
+    hash_rcu_leer_fin(hash, lectura);
+    return pertenece;
+}
+
+size_t hash_rcu_cantidad(hash_rcu_t *hash) {
+    return __atomic_load_n(&hash->cantidad, __ATOMIC_RELAXED);
+}
+
+/* ******************************************************************
+ *                   ESCRITURAS (con el mutex tomado)
+ * *****************************************************************/
+
+static void liberar(hash_rcu_t *hash, void *puntero, tipo_retiro_t tipo) {
+    if (tipo == RETIRO_DATO) hash->funcion_destruccion(puntero);
+    else free(puntero);
+}
+
+/* Los lectores suman a su contador y después releen la época; acá se cambia
+ * la época y después se leen los contadores. Las lecturas son SEQ_CST para
+ * que no se adelanten al cambio de época: si no, un lector podría ver la
+ * época vieja y esta función su contador todavía en cero.
+ */
+static void esperar_lectores(hash_rcu_t *hash) {
+    unsigned anterior = hash->epoca & 1;
+    __atomic_store_n(&hash->epoca, hash->epoca + 1, __ATOMIC_SEQ_CST);
+    for (size_t i = 0; i < RANURAS_LECTORES; i++) {
+        while (__atomic_load_n(&hash->ranuras[i].lectores[anterior], __ATOMIC_SEQ_CST) != 0) sched_yield();
+    }
+}
+
+static void vaciar_retirados(hash_rcu_t *hash) {
+    for (size_t i = 0; i < hash->cantidad_retirados; i++) {
+        liberar(hash, hash->retirados[i].puntero, hash->retirados[i].tipo);
+    }
+    hash->cantidad_retirados = 0;
+}
+
+static void liberar_retirados(hash_rcu_t *hash) {
+    if (hash->cantidad_retirados == 0) return;
+    esperar_lectores(hash);
+    vaciar_retirados(hash);
+}
+
+// Deja el puntero para liberarlo cuando ningún lector pueda tenerlo.
+static void retirar(hash_rcu_t *hash, void *puntero, tipo_retiro_t tipo) {
+    if (hash->cantidad_retirados == hash->capacidad_retirados) {
+        size_t capacidad = hash->capacidad_retirados ? hash->capacidad_retirados * 2 : RETIRADOS_MAX;
+        retiro_t *retirados = realloc(hash->retirados, capacidad * sizeof(retiro_t));
+        if (!retirados) {
+            // Sin lugar para anotarlo, se espera a los lectores en el momento.
+            esperar_lectores(hash);
+            vaciar_retirados(hash);
+            liberar(hash, puntero, tipo);
+            return;
+        }
+        hash->retirados = retirados;
+        hash->capacidad_retirados = capacidad;
+    }
+    hash->retirados[hash->cantidad_retirados++] = (retiro_t) { puntero, tipo };
+    if (hash->cantidad_retirados >= RETIRADOS_MAX) liberar_retirados(hash);
+}
+
+/* Devuelve la posición de la clave en la tabla, o la capacidad si no está.
+ * En ese caso deja en libre el primer lugar borrado o vacío del sondeo.
+ */
+static size_t buscar_posicion(const tabla_t *tabla, const char *clave, size_t largo, unsigned long h,
+                              size_t *libre) {
+    size_t pos = h & (tabla->capacidad - 1);
+    *libre = tabla->capacidad;
+
+    while (tabla->campos[pos]) {
+        entrada_t *entrada = tabla->campos[pos];
+        if (entrada == BORRADA) {
+            if (*libre == tabla->capacidad) *libre = pos;
+        } else if (entrada->hash == h && entrada->largo == largo && memcmp(entrada->clave, clave, largo) == 0) {
+            return pos;
+        }
+        pos = (pos + 1) & (tabla->capacidad - 1);
+    }
+    if (*libre == tabla->capacidad) *libre = pos;
+    return tabla->capacidad;
+}
+
+/* Arma la tabla nueva aparte y la publica entera; los lectores que estén en
+ * la vieja la siguen viendo igual hasta terminar.
+ */
+static bool redimensionar(hash_rcu_t *hash, size_t nueva_capacidad) {
+    tabla_t *nueva = crear_tabla(nueva_capacidad);
+    if (!nueva) return false;
+
+    tabla_t *vieja = hash->tabla;
+    for (size_t i = 0; i < vieja->capacidad; i++) {
+        entrada_t *entrada = vieja->campos[i];
+        if (!entrada || entrada == BORRADA) continue;
+        size_t pos = entrada->hash & (nueva_capacidad - 1);
+        while (nueva->campos[pos]) pos = (pos + 1) & (nueva_capacidad - 1);
+        nueva->campos[pos] = entrada;
+    }
+    __atomic_store_n(&hash->tabla, nueva, __ATOMIC_RELEASE);
+    hash->borrados = 0;
+    retirar(hash, vieja, RETIRO_TABLA);
+    // Las tablas viejas son grandes: conviene liberarlas enseguida.
+    liberar_retirados(hash);
+    return true;
+}
+
+bool hash_rcu_guardar(hash_rcu_t *hash, const char *clave, void *dato) {
+    size_t largo = strlen(clave);
+    unsigned long h = hash_wyhash(clave, largo);
+    pthread_mutex_lock(&hash->escritura);
+
+    tabla_t *tabla = hash->tabla;
+    if ((double) (hash->cantidad + hash->borrados + 1) > (double) tabla->capacidad * VALOR_CARGA) {
+        size_t nueva_capacidad = hash->borrados >= hash->cantidad ? tabla->capacidad : tabla->capacidad * 2;
+        if (!redimensionar(hash, nueva_capacidad)) {
+            pthread_mutex_unlock(&hash->escritura);
+            return false;
+        }
+        tabla = hash->tabla;
+    }
+
+    size_t libre;
+    size_t pos = buscar_posicion(tabla, clave, largo, h, &libre);
+    if (pos != tabla->capacidad) {
+        entrada_t *entrada = tabla->campos[pos];
+        void *anterior = __atomic_exchange_n(&entrada->valor, dato, __ATOMIC_ACQ_REL);
+        if (hash->funcion_destruccion) retirar(hash, anterior, RETIRO_DATO);
+        pthread_mutex_unlock(&hash->escritura);
+        return true;
+    }
+
+    entrada_t *entrada = malloc(sizeof(entrada_t) + largo + 1);
+    if (!entrada) {
+        pthread_mutex_unlock(&hash->escritura);
+        return false;
+    }
+    entrada->hash = h;
+    entrada->valor = dato;
+    entrada->largo = largo;
+    memcpy(entrada->clave, clave, largo + 1);
+
+    if (tabla->campos[libre] == BORRADA) hash->borrados--;
+    __atomic_store_n(&tabla->campos[libre], entrada, __ATOMIC_RELEASE);
+    __atomic_store_n(&hash->cantidad, hash->cantidad + 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&hash->escritura);
+    return true;
+}
+
+void *hash_rcu_borrar(hash_rcu_t *hash, const char *clave) {
+    size_t largo = strlen(clave);
+    unsigned long h = hash_wyhash(clave, largo);
+    pthread_mutex_lock(&hash->escritura);
+
+    tabla_t *tabla = hash->tabla;
+    size_t libre;
+    size_t pos = buscar_posicion(tabla, clave, largo, h, &libre);
+    if (pos == tabla->capacidad) {
+        pthread_mutex_unlock(&hash->escritura);
+        return NULL;
+    }
+
+    entrada_t *entrada = tabla->campos[pos];
+    void *valor = entrada->valor;
+    __atomic_store_n(&tabla->campos[pos], BORRADA, __ATOMIC_RELEASE);
+    hash->borrados++;
+    __atomic_store_n(&hash->cantidad, hash->cantidad - 1, __ATOMIC_RELAXED);
+    retirar(hash, entrada, RETIRO_ENTRADA);
+    pthread_mutex_unlock(&hash->escritura);
+    return valor;
+}
+
+void hash_rcu_sincronizar(hash_rcu_t *hash) {
+    pthread_mutex_lock(&hash->escritura);
+    esperar_lectores(hash);
+    vaciar_retirados(hash);
+    pthread_mutex_unlock(&hash->escritura);
+}
+
+void hash_rcu_destruir(hash_rcu_t *hash) {
+    vaciar_retirados(hash);
+    free(hash->retirados);
+
+    for (size_t i = 0; i < hash->tabla->capacidad; i++) {
+        entrada_t *entrada = hash->tabla->campos[i];
+        if (!entrada || entrada == BORRADA) continue;
+        if (hash->funcion_destruccion) hash->funcion_destruccion(entrada->valor);
+        free(entrada);
+    }
+    free(hash->tabla);
+    pthread_mutex_destroy(&hash->escritura);
+    free(hash);
+}
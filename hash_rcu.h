@@ -0,0 +1,75 @@
+#ifndef HASH_RCU_H
+#define HASH_RCU_H
+
+#include "hash.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Tabla de hash para datos que se leen mucho más de lo que se modifican.
+ * Las búsquedas no toman ningún lock: se pueden hacer desde cualquier
+ * cantidad de hilos a la vez, también mientras otro hilo guarda o borra. Las
+ * modificaciones se hacen de a una, y las claves, datos y tablas viejas se
+ * liberan recién cuando ningún lector puede estar usándolos.
+ */
+struct hash_rcu;
+typedef struct hash_rcu hash_rcu_t;
+
+/* Crea el hash.
+ */
+hash_rcu_t *hash_rcu_crear(hash_destruir_dato_t destruir_dato);
+
+/* Guarda un elemento, reemplazando el dato si la clave ya estaba. El dato
+ * reemplazado se destruye cuando ningún lector puede estar usándolo. De no
+ * poder guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_rcu_guardar(hash_rcu_t *hash, const char *clave, void *dato);
+
+/* Borra un elemento y devuelve el dato asociado, o NULL si no estaba. Los
+ * lectores pueden seguir usando el dato hasta que hash_rcu_sincronizar
+ * vuelva; recién ahí se lo puede destruir.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_rcu_borrar(hash_rcu_t *hash, const char *clave);
+
+/* Obtiene el dato asociado a la clave, o NULL si no está, sin bloquearse.
+ * Para usar el dato sin que otro hilo lo destruya, la búsqueda y el uso
+ * tienen que estar entre hash_rcu_leer_inicio y hash_rcu_leer_fin.
+ * Pre: La estructura hash fue inicializada
+ */
+void *hash_rcu_obtener(hash_rcu_t *hash, const char *clave);
+
+/* Determina si la clave pertenece al hash, sin bloquearse.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_rcu_pertenece(hash_rcu_t *hash, const char *clave);
+
+/* Devuelve la cantidad de elementos.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_rcu_cantidad(hash_rcu_t *hash);
+
+/* Marcan una sección de lectura: lo que se obtenga dentro no se libera hasta
+ * que termine. Devuelve un valor que hay que pasarle a hash_rcu_leer_fin.
+ * Las secciones se pueden anidar, pero dentro de una no se puede modificar
+ * el hash desde el mismo hilo.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_rcu_leer_inicio(hash_rcu_t *hash);
+void hash_rcu_leer_fin(hash_rcu_t *hash, size_t lectura);
+
+/* Espera a que terminen todas las lecturas empezadas hasta ahora y libera
+ * lo que quedó pendiente de las modificaciones anteriores.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_rcu_sincronizar(hash_rcu_t *hash);
+
+/* Destruye la estructura, llamando a la función destruir para cada dato.
+ * Ningún otro hilo puede estar usando el hash.
+ * Pre: La estructura hash fue inicializada
+ * Post: La estructura hash fue destruida
+ */
+void hash_rcu_destruir(hash_rcu_t *hash);
+
+#endif  // HASH_RCU_H
@@ -0,0 +1,213 @@
+/*
+ * hash_rcu_pruebas.c
+ * Pruebas para la Tabla de Hash con lecturas sin bloqueo
+ */
+
+#include "hash_rcu.h"
+#include "testing.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LECTORES_PRUEBA 4
+#define CLAVES_PRUEBA 2000
+#define VUELTAS_ESCRITOR 5
+#define LARGO_CLAVE_PRUEBA 24
+
+
+/* ******************************************************************
+ *                        PRUEBAS UNITARIAS
+ * *****************************************************************/
+
+static void prueba_hash_rcu_basico()
+{
+    hash_rcu_t* hash = hash_rcu_crear(NULL);
+
+    char *clave1 = "perro", *valor1 = "guau", *valor1b = "GUAU";
+    char *clave2 = "gato", *valor2 = "miau";
+
+    print_test("Prueba hash rcu crear", hash);
+    print_test("Prueba hash rcu obtener clave1, es NULL, no existe", !hash_rcu_obtener(hash, clave1));
+    print_test("Prueba hash rcu guardar clave1", hash_rcu_guardar(hash, clave1, valor1));
+    print_test("Prueba hash rcu guardar clave2", hash_rcu_guardar(hash, clave2, valor2));
+    print_test("Prueba hash rcu la cantidad de elementos es 2", hash_rcu_cantidad(hash) == 2);
+    print_test("Prueba hash rcu obtener clave1 es valor1", hash_rcu_obtener(hash, clave1) == valor1);
+    print_test("Prueba hash rcu reemplazar clave1", hash_rcu_guardar(hash, clave1, valor1b));
+    print_test("Prueba hash rcu obtener clave1 es valor1b", hash_rcu_obtener(hash, clave1) == valor1b);
+    print_test("Prueba hash rcu borrar clave1 es valor1b", hash_rcu_borrar(hash, clave1) == valor1b);
+    print_test("Prueba hash rcu clave1 no pertenece", !hash_rcu_pertenece(hash, clave1));
+    print_test("Prueba hash rcu clave2 pertenece", hash_rcu_pertenece(hash, clave2));
+    print_test("Prueba hash rcu la cantidad de elementos es 1", hash_rcu_cantidad(hash) == 1);
+
+    hash_rcu_sincronizar(hash);
+    hash_rcu_destruir(hash);
+}
+
+typedef struct lector_prueba {
+    hash_rcu_t* hash;
+    char (*claves)[LARGO_CLAVE_PRUEBA];
+    bool* terminado;
+    bool ok;
+} lector_prueba_t;
+
+/* Busca todas las claves hasta que el escritor termine. Cada dato es el
+ * número de su clave; leerlo dentro de la sección de lectura falla (con
+ * ASan o TSan) si se liberó antes de tiempo.
+ */
+static void *leer(void *extra)
+{
+    lector_prueba_t* lector = extra;
+    lector->ok = true;
+
+    while (!__atomic_load_n(lector->terminado, __ATOMIC_ACQUIRE) && lector->ok) {
+        for (size_t i = 0; i < CLAVES_PRUEBA && lector->ok; i++) {
+            size_t lectura = hash_rcu_leer_inicio(lector->hash);
+            size_t *dato = hash_rcu_obtener(lector->hash, lector->claves[i]);
+            lector->ok = !dato || *dato == i;
+            hash_rcu_leer_fin(lector->hash, lectura);
+        }
+    }
+    return NULL;
+}
+
+static size_t *crear_dato(size_t valor)
+{
+    size_t *dato = malloc(sizeof(size_t));
+    *dato = valor;
+    return dato;
+}
+
+static void prueba_hash_rcu_lectores_y_escritor()
+{
+    hash_rcu_t* hash = hash_rcu_crear(free);
+    char (*claves)[LARGO_CLAVE_PRUEBA] = crear_claves_prueba(CLAVES_PRUEBA, LARGO_CLAVE_PRUEBA);
+
+    bool terminado = false;
+    pthread_t hilos[LECTORES_PRUEBA];
+    lector_prueba_t lectores[LECTORES_PRUEBA];
+    for (size_t i = 0; i < LECTORES_PRUEBA; i++) {
+        lectores[i] = (lector_prueba_t) { .hash = hash, .claves = claves, .terminado = &terminado };
+        pthread_create(&hilos[i], NULL, leer, &lectores[i]);
+    }
+
+    /* Mientras tanto guarda (con redimensiones), reemplaza y borra */
+    bool ok = true;
+    for (size_t vuelta = 0; vuelta < VUELTAS_ESCRITOR && ok; vuelta++) {
+        for (size_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+            ok = hash_rcu_guardar(hash, claves[i], crear_dato(i));
+        }
+        for (size_t i = vuelta % 3; i < CLAVES_PRUEBA && ok; i += 3) {
+            size_t *dato = hash_rcu_borrar(hash, claves[i]);
+            ok = dato && *dato == i;
+            hash_rcu_sincronizar(hash);
+            free(dato);
+        }
+    }
+    __atomic_store_n(&terminado, true, __ATOMIC_RELEASE);
+
+    for (size_t i = 0; i < LECTORES_PRUEBA; i++) {
+        pthread_join(hilos[i], NULL);
+        ok = ok && lectores[i].ok;
+    }
+    print_test("Prueba hash rcu lectores sin bloqueo con un escritor", ok);
+
+    size_t borrados = 0;
+    for (size_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+        size_t *dato = hash_rcu_obtener(hash, claves[i]);
+        if (dato) ok = *dato == i;
+        else borrados++;
+    }
+    ok = ok && borrados == (CLAVES_PRUEBA + 2) / 3;
+    print_test("Prueba hash rcu quedan las claves de la ultima vuelta", ok);
+    print_test("Prueba hash rcu la cantidad de elementos es correcta",
+               hash_rcu_cantidad(hash) == CLAVES_PRUEBA - (CLAVES_PRUEBA + 2) / 3);
+
+    free(claves);
+    hash_rcu_destruir(hash);
+}
+
+static size_t destruidos;
+
+static void contar_destruido(void *dato)
+{
+    (void) dato;
+    __atomic_add_fetch(&destruidos, 1, __ATOMIC_RELAXED);
+}
+
+enum { LECTOR_EMPEZANDO, LECTOR_LEYENDO, DATO_REEMPLAZADO };
+
+typedef struct lector_lento {
+    hash_rcu_t* hash;
+    int* esperado;
+    int estado;
+    bool ok;
+} lector_lento_t;
+
+/* Obtiene el dato y no termina la sección de lectura hasta que el escritor
+ * lo haya reemplazado: para entonces no se tiene que haber destruido. */
+static void *leer_lento(void *extra)
+{
+    lector_lento_t* lector = extra;
+    size_t lectura = hash_rcu_leer_inicio(lector->hash);
+    int* dato = hash_rcu_obtener(lector->hash, "clave");
+    __atomic_store_n(&lector->estado, LECTOR_LEYENDO, __ATOMIC_RELEASE);
+    while (__atomic_load_n(&lector->estado, __ATOMIC_ACQUIRE) != DATO_REEMPLAZADO) sched_yield();
+    lector->ok = dato == lector->esperado && *dato == 1 && __atomic_load_n(&destruidos, __ATOMIC_RELAXED) == 0;
+    hash_rcu_leer_fin(lector->hash, lectura);
+    return NULL;
+}
+
+static void prueba_hash_rcu_retiro()
+{
+    int datos[] = { 1, 2 };
+    destruidos = 0;
+    hash_rcu_t* hash = hash_rcu_crear(contar_destruido);
+    print_test("Prueba hash rcu retiro guardar clave", hash_rcu_guardar(hash, "clave", &datos[0]));
+
+    pthread_t hilo;
+    lector_lento_t lector = { .hash = hash, .esperado = &datos[0], .estado = LECTOR_EMPEZANDO };
+    pthread_create(&hilo, NULL, leer_lento, &lector);
+    while (__atomic_load_n(&lector.estado, __ATOMIC_ACQUIRE) != LECTOR_LEYENDO) sched_yield();
+
+    bool ok = hash_rcu_guardar(hash, "clave", &datos[1]);
+    print_test("Prueba hash rcu retiro reemplazar no destruye el dato enseguida", ok && destruidos == 0);
+
+    /* sincronizar espera a que el lector termine y recién ahí destruye */
+    __atomic_store_n(&lector.estado, DATO_REEMPLAZADO, __ATOMIC_RELEASE);
+    hash_rcu_sincronizar(hash);
+    pthread_join(hilo, NULL);
+    print_test("Prueba hash rcu retiro el lector usa el dato reemplazado", lector.ok);
+    print_test("Prueba hash rcu retiro sincronizar destruye el dato reemplazado", destruidos == 1);
+
+    print_test("Prueba hash rcu retiro borrar devuelve el dato sin destruirlo",
+               hash_rcu_borrar(hash, "clave") == &datos[1] && destruidos == 1);
+    hash_rcu_sincronizar(hash);
+    print_test("Prueba hash rcu retiro el dato borrado no se destruye al sincronizar", destruidos == 1);
+
+    /* Sin sincronizar, los retirados se liberan de a tandas */
+    const size_t reemplazos = 1000;
+    ok = true;
+    for (size_t i = 0; i <= reemplazos && ok; i++) ok = hash_rcu_guardar(hash, "clave", &datos[i % 2]);
+    print_test("Prueba hash rcu retiro reemplazar muchas veces", ok);
+    print_test("Prueba hash rcu retiro se destruyen datos sin sincronizar",
+               destruidos > 1 && destruidos < 1 + reemplazos);
+
+    hash_rcu_destruir(hash);
+    print_test("Prueba hash rcu retiro destruir libera los pendientes y el actual", destruidos == 2 + reemplazos);
+}
+
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+
+void pruebas_hash_rcu()
+{
+    /* Ejecuta todas las pruebas unitarias. */
+    prueba_hash_rcu_basico();
+    prueba_hash_rcu_lectores_y_escritor();
+    prueba_hash_rcu_retiro();
+}
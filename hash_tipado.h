@@ -0,0 +1,221 @@
+#ifndef HASH_TIPADO_H
+#define HASH_TIPADO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Generador de tablas de hash para tipos concretos. A diferencia de hash_t,
+ * las claves y los valores se guardan por copia dentro de la tabla, sin pedir
+ * memoria para cada elemento, y el compilador puede expandir en línea las
+ * funciones de hash y de comparación. Conviene para valores chicos sin
+ * punteros (enteros, structs de pocos campos).
+ *
+ *     HASH_TIPADO_DECLARAR(edades, uint64_t, int, hash_tipado_entero, HASH_TIPADO_IGUALES)
+ *
+ * declara el tipo edades_t y las funciones edades_crear, edades_guardar,
+ * edades_lugar, edades_obtener, edades_pertenece, edades_borrar,
+ * edades_cantidad, edades_siguiente y edades_destruir, todas static inline.
+ * hashear(clave) tiene que devolver un entero de 64 bits con los bits bajos
+ * bien dispersos, e iguales(a, b) un bool; pueden ser funciones o macros.
+ *
+ * Guardar reemplaza el valor si la clave ya estaba. lugar devuelve un
+ * puntero al valor de la clave, agregándola con el valor sin inicializar si
+ * no estaba (y dejando 'agregada' en true), o NULL si no hay memoria: sirve
+ * para ver el valor anterior antes de reemplazarlo con una sola búsqueda.
+ * obtener devuelve un puntero al valor dentro de la tabla, o NULL si la
+ * clave no está. Esos punteros dejan de ser válidos al modificar la tabla.
+ * borrar copia el valor borrado en 'borrado' si no es NULL y devuelve si la
+ * clave estaba. siguiente recorre la tabla: se empieza con *posicion en 0 y
+ * devuelve false al terminar.
+ *
+ * Para guardar la tabla dentro de otra estructura en vez de pedirla con
+ * crear, edades_inicializar la prepara (devuelve false si no hay memoria) y
+ * edades_liberar libera lo que pidió, sin tocar la estructura.
+ *
+ * Es sondeo lineal sin marcas de borrado: al borrar, los elementos
+ * siguientes que pueden acercarse a su posición original se corren hacia
+ * atrás. hash_entero es una instancia con claves uint64_t y datos void*.
+ */
+
+#define HASH_TIPADO_VACIO 0x80
+#define HASH_TIPADO_CAPACIDAD_INICIAL 32
+#define HASH_TIPADO_FACTOR_ACHICAR 4
+
+// Carga máxima, como fracción entera para no usar punto flotante al guardar.
+#define HASH_TIPADO_CARGA_NUMERADOR 7
+#define HASH_TIPADO_CARGA_DENOMINADOR 10
+
+#define HASH_TIPADO_IGUALES(a, b) ((a) == (b))
+
+// Source: https://prng.di.unimi.it/splitmix64.c
+static inline uint64_t hash_tipado_entero(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+#define HASH_TIPADO_DECLARAR(nombre, tipo_clave, tipo_valor, hashear, iguales)                              \
+                                                                                                            \
+typedef struct nombre##_campo {                                                                             \
+    tipo_clave clave;                                                                                       \
+    tipo_valor valor;                                                                                       \
+} nombre##_campo_t;                                                                                         \
+                                                                                                            \
+typedef struct nombre {                                                                                     \
+    size_t capacidad;                                                                                       \
+    size_t cantidad;                                                                                        \
+    size_t maximo;                                                                                          \
+    nombre##_campo_t *campos;                                                                               \
+    unsigned char *control;                                                                                 \
+} nombre##_t;                                                                                               \
+                                                                                                            \
+static inline bool nombre##_crear_tabla(nombre##_t *hash, size_t capacidad) {                               \
+    nombre##_campo_t *campos = malloc(capacidad * sizeof(nombre##_campo_t));                                \
+    unsigned char *control = malloc(capacidad);                                                             \
+    if (!campos || !control) {                                                                              \
+        free(campos);                                                                                       \
+        free(control);                                                                                      \
+        return false;                                                                                       \
+    }                                                                                                       \
+    memset(control, HASH_TIPADO_VACIO, capacidad);                                                          \
+    hash->campos = campos;                                                                                  \
+    hash->control = control;                                                                                \
+    hash->capacidad = capacidad;                                                                            \
+    hash->maximo = capacidad / HASH_TIPADO_CARGA_DENOMINADOR * HASH_TIPADO_CARGA_NUMERADOR;                 \
+    return true;                                                                                            \
+}                                                                                                           \
+                                                                                                            \
+static inline size_t nombre##_colocar(nombre##_t *hash, const nombre##_campo_t *campo, uint64_t h) {        \
+    size_t mascara = hash->capacidad - 1;                                                                   \
+    size_t pos = h & mascara;                                                                               \
+    while (hash->control[pos] != HASH_TIPADO_VACIO) pos = (pos + 1) & mascara;                              \
+    hash->campos[pos] = *campo;                                                                             \
+    hash->control[pos] = (unsigned char) (h >> 57);                                                         \
+    return pos;                                                                                             \
+}                                                                                                           \
+                                                                                                            \
+static inline bool nombre##_redimensionar(nombre##_t *hash, size_t capacidad) {                             \
+    nombre##_campo_t *campos = hash->campos;                                                                \
+    unsigned char *control = hash->control;                                                                 \
+    size_t capacidad_vieja = hash->capacidad;                                                               \
+    if (!nombre##_crear_tabla(hash, capacidad)) return false;                                               \
+    for (size_t i = 0; i < capacidad_vieja; i++) {                                                          \
+        if (control[i] != HASH_TIPADO_VACIO) {                                                              \
+            nombre##_colocar(hash, &campos[i], (uint64_t) hashear(campos[i].clave));                        \
+        }                                                                                                   \
+    }                                                                                                       \
+    free(campos);                                                                                           \
+    free(control);                                                                                          \
+    return true;                                                                                            \
+}                                                                                                           \
+                                                                                                            \
+static inline size_t nombre##_buscar(const nombre##_t *hash, tipo_clave clave, uint64_t h) {                \
+    size_t mascara = hash->capacidad - 1;                                                                   \
+    unsigned char buscada = (unsigned char) (h >> 57);                                                      \
+    for (size_t pos = h & mascara; hash->control[pos] != HASH_TIPADO_VACIO; pos = (pos + 1) & mascara) {    \
+        if (hash->control[pos] == buscada && iguales(hash->campos[pos].clave, clave)) return pos;           \
+    }                                                                                                       \
+    return hash->capacidad;                                                                                 \
+}                                                                                                           \
+                                                                                                            \
+static inline bool nombre##_inicializar(nombre##_t *hash) {                                                 \
+    if (!nombre##_crear_tabla(hash, HASH_TIPADO_CAPACIDAD_INICIAL)) return false;                           \
+    hash->cantidad = 0;                                                                                     \
+    return true;                                                                                            \
+}                                                                                                           \
+                                                                                                            \
+static inline nombre##_t *nombre##_crear(void) {                                                            \
+    nombre##_t *hash = malloc(sizeof(nombre##_t));                                                          \
+    if (!hash) return NULL;                                                                                 \
+    if (!nombre##_inicializar(hash)) {                                                                      \
+        free(hash);                                                                                         \
+        return NULL;                                                                                        \
+    }                                                                                                       \
+    return hash;                                                                                            \
+}                                                                                                           \
+                                                                                                            \
+static inline tipo_valor *nombre##_lugar(nombre##_t *hash, tipo_clave clave, bool *agregada) {              \
+    uint64_t h = (uint64_t) hashear(clave);                                                                 \
+    size_t pos = nombre##_buscar(hash, clave, h);                                                           \
+    *agregada = pos == hash->capacidad;                                                                     \
+    if (!*agregada) return &hash->campos[pos].valor;                                                        \
+    if (hash->cantidad >= hash->maximo && !nombre##_redimensionar(hash, hash->capacidad * 2)) return NULL;  \
+    nombre##_campo_t campo = { .clave = clave };                                                            \
+    pos = nombre##_colocar(hash, &campo, h);                                                                \
+    hash->cantidad++;                                                                                       \
+    return &hash->campos[pos].valor;                                                                        \
+}                                                                                                           \
+                                                                                                            \
+static inline bool nombre##_guardar(nombre##_t *hash, tipo_clave clave, tipo_valor valor) {                 \
+    bool agregada;                                                                                          \
+    tipo_valor *lugar = nombre##_lugar(hash, clave, &agregada);                                             \
+    if (!lugar) return false;                                                                               \
+    *lugar = valor;                                                                                         \
+    return true;                                                                                            \
+}                                                                                                           \
+                                                                                                            \
+static inline tipo_valor *nombre##_obtener(const nombre##_t *hash, tipo_clave clave) {                      \
+    size_t pos = nombre##_buscar(hash, clave, (uint64_t) hashear(clave));                                   \
+    return pos == hash->capacidad ? NULL : &hash->campos[pos].valor;                                        \
+}                                                                                                           \
+                                                                                                            \
+static inline bool nombre##_pertenece(const nombre##_t *hash, tipo_clave clave) {                           \
+    return nombre##_buscar(hash, clave, (uint64_t) hashear(clave)) != hash->capacidad;                      \
+}                                                                                                           \
+                                                                                                            \
+static inline bool nombre##_borrar(nombre##_t *hash, tipo_clave clave, tipo_valor *borrado) {               \
+    size_t vacio = nombre##_buscar(hash, clave, (uint64_t) hashear(clave));                                 \
+    if (vacio == hash->capacidad) return false;                                                             \
+    if (borrado) *borrado = hash->campos[vacio].valor;                                                      \
+                                                                                                            \
+    size_t mascara = hash->capacidad - 1;                                                                   \
+    for (size_t pos = (vacio + 1) & mascara; hash->control[pos] != HASH_TIPADO_VACIO;                       \
+         pos = (pos + 1) & mascara) {                                                                       \
+        size_t origen = (uint64_t) hashear(hash->campos[pos].clave) & mascara;                              \
+        if (((pos - origen) & mascara) >= ((pos - vacio) & mascara)) {                                      \
+            hash->campos[vacio] = hash->campos[pos];                                                        \
+            hash->control[vacio] = hash->control[pos];                                                      \
+            vacio = pos;                                                                                    \
+        }                                                                                                   \
+    }                                                                                                       \
+    hash->control[vacio] = HASH_TIPADO_VACIO;                                                               \
+    hash->cantidad--;                                                                                       \
+                                                                                                            \
+    if (hash->capacidad > HASH_TIPADO_CAPACIDAD_INICIAL &&                                                  \
+        hash->cantidad * HASH_TIPADO_FACTOR_ACHICAR < hash->maximo) {                                       \
+        nombre##_redimensionar(hash, hash->capacidad / 2);                                                  \
+    }                                                                                                       \
+    return true;                                                                                            \
+}                                                                                                           \
+                                                                                                            \
+static inline size_t nombre##_cantidad(const nombre##_t *hash) {                                            \
+    return hash->cantidad;                                                                                  \
+}                                                                                                           \
+                                                                                                            \
+static inline bool nombre##_siguiente(const nombre##_t *hash, size_t *posicion, tipo_clave *clave,          \
+                                      tipo_valor *valor) {                                                  \
+    for (size_t pos = *posicion; pos < hash->capacidad; pos++) {                                            \
+        if (hash->control[pos] == HASH_TIPADO_VACIO) continue;                                              \
+        if (clave) *clave = hash->campos[pos].clave;                                                        \
+        if (valor) *valor = hash->campos[pos].valor;                                                        \
+        *posicion = pos + 1;                                                                                \
+        return true;                                                                                        \
+    }                                                                                                       \
+    *posicion = hash->capacidad;                                                                            \
+    return false;                                                                                           \
+}                                                                                                           \
+                                                                                                            \
+static inline void nombre##_liberar(nombre##_t *hash) {                                                     \
+    free(hash->campos);                                                                                     \
+    free(hash->control);                                                                                    \
+}                                                                                                           \
+                                                                                                            \
+static inline void nombre##_destruir(nombre##_t *hash) {                                                    \
+    nombre##_liberar(hash);                                                                                 \
+    free(hash);                                                                                             \
+}
+
+#endif  // HASH_TIPADO_H
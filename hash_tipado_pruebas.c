@@ -0,0 +1,133 @@
+/*
+ * hash_tipado_pruebas.c
+ * Pruebas para las Tablas de Hash generadas con hash_tipado.h
+ */
+
+#include "hash_tipado.h"
+#include "testing.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define CLAVES_PRUEBA 20000
+
+typedef struct punto {
+    int32_t x, y;
+} punto_t;
+
+static uint64_t hashear_punto(punto_t punto)
+{
+    return hash_tipado_entero((uint64_t) (uint32_t) punto.x << 32 | (uint32_t) punto.y);
+}
+
+#define PUNTOS_IGUALES(a, b) ((a).x == (b).x && (a).y == (b).y)
+
+HASH_TIPADO_DECLARAR(edades, uint64_t, int, hash_tipado_entero, HASH_TIPADO_IGUALES)
+HASH_TIPADO_DECLARAR(distancias, punto_t, double, hashear_punto, PUNTOS_IGUALES)
+
+
+/* ******************************************************************
+ *                        PRUEBAS UNITARIAS
+ * *****************************************************************/
+
+static void prueba_hash_tipado_basico()
+{
+    edades_t* hash = edades_crear();
+
+    print_test("Prueba hash tipado crear", hash);
+    print_test("Prueba hash tipado obtener 0, es NULL, no existe", !edades_obtener(hash, 0));
+    print_test("Prueba hash tipado guardar 0", edades_guardar(hash, 0, 10));
+    print_test("Prueba hash tipado guardar UINT64_MAX", edades_guardar(hash, UINT64_MAX, 20));
+    print_test("Prueba hash tipado la cantidad de elementos es 2", edades_cantidad(hash) == 2);
+
+    int* edad = edades_obtener(hash, 0);
+    print_test("Prueba hash tipado obtener 0 es 10", edad && *edad == 10);
+    if (edad) *edad = 11;
+    edad = edades_obtener(hash, 0);
+    print_test("Prueba hash tipado el valor se modifica en la tabla", edad && *edad == 11);
+    print_test("Prueba hash tipado reemplazar UINT64_MAX", edades_guardar(hash, UINT64_MAX, 21));
+    edad = edades_obtener(hash, UINT64_MAX);
+    print_test("Prueba hash tipado obtener UINT64_MAX es 21", edad && *edad == 21);
+    print_test("Prueba hash tipado la cantidad de elementos sigue en 2", edades_cantidad(hash) == 2);
+
+    int borrada = 0;
+    print_test("Prueba hash tipado borrar 0", edades_borrar(hash, 0, &borrada) && borrada == 11);
+    print_test("Prueba hash tipado 0 no pertenece", !edades_pertenece(hash, 0));
+    print_test("Prueba hash tipado borrar 0 de nuevo es false", !edades_borrar(hash, 0, NULL));
+    print_test("Prueba hash tipado la cantidad de elementos es 1", edades_cantidad(hash) == 1);
+
+    bool agregada = false;
+    edad = edades_lugar(hash, UINT64_MAX, &agregada);
+    print_test("Prueba hash tipado lugar de UINT64_MAX tiene 21", edad && !agregada && *edad == 21);
+    edad = edades_lugar(hash, 5, &agregada);
+    print_test("Prueba hash tipado lugar de 5 la agrega", edad && agregada && edades_cantidad(hash) == 2);
+    if (edad) *edad = 50;
+    edad = edades_obtener(hash, 5);
+    print_test("Prueba hash tipado obtener 5 es 50", edad && *edad == 50);
+
+    edades_destruir(hash);
+}
+
+static void prueba_hash_tipado_struct_volumen()
+{
+    distancias_t* hash = distancias_crear();
+
+    bool ok = true;
+    for (int32_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+        punto_t punto = { i, -i };
+        ok = distancias_guardar(hash, punto, (double) i / 2);
+    }
+    print_test("Prueba hash tipado guardar muchos structs", ok && distancias_cantidad(hash) == CLAVES_PRUEBA);
+    size_t capacidad_llena = hash->capacidad;
+
+    for (int32_t i = 0; i < CLAVES_PRUEBA && ok; i += 3) {
+        punto_t punto = { i, -i };
+        double borrada;
+        ok = distancias_borrar(hash, punto, &borrada) && borrada == (double) i / 2;
+    }
+    for (int32_t i = 0; i < CLAVES_PRUEBA && ok; i++) {
+        punto_t punto = { i, -i };
+        double* distancia = distancias_obtener(hash, punto);
+        ok = i % 3 ? distancia && *distancia == (double) i / 2 : !distancia;
+    }
+    print_test("Prueba hash tipado borrar un tercio y buscar el resto", ok);
+
+    size_t posicion = 0, visitados = 0;
+    punto_t punto;
+    double distancia;
+    while (ok && distancias_siguiente(hash, &posicion, &punto, &distancia)) {
+        ok = punto.y == -punto.x && distancia == (double) punto.x / 2;
+        visitados++;
+    }
+    print_test("Prueba hash tipado recorrer visita todos los elementos",
+               ok && visitados == distancias_cantidad(hash) && visitados == CLAVES_PRUEBA - (CLAVES_PRUEBA + 2) / 3);
+
+    /* Borrar casi todo achica la tabla hasta su capacidad inicial */
+    for (int32_t i = 10; i < CLAVES_PRUEBA && ok; i++) {
+        punto_t borrado = { i, -i };
+        ok = i % 3 == 0 || distancias_borrar(hash, borrado, NULL);
+    }
+    print_test("Prueba hash tipado borrar casi todo", ok && distancias_cantidad(hash) == 6);
+    print_test("Prueba hash tipado la tabla se achico a su capacidad inicial",
+               hash->capacidad == HASH_TIPADO_CAPACIDAD_INICIAL && capacidad_llena > HASH_TIPADO_CAPACIDAD_INICIAL);
+    for (int32_t i = 1; i < 10 && ok; i++) {
+        punto_t quedo = { i, -i };
+        ok = i % 3 == 0 || distancias_pertenece(hash, quedo);
+    }
+    print_test("Prueba hash tipado quedan los elementos no borrados", ok);
+
+    distancias_destruir(hash);
+}
+
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+
+void pruebas_hash_tipado()
+{
+    /* Ejecuta todas las pruebas unitarias. */
+    prueba_hash_tipado_basico();
+    prueba_hash_tipado_struct_volumen();
+}
@@ -9,6 +9,11 @@
 
 void pruebas_hash_catedra(void);
 void pruebas_volumen_catedra(size_t);
+void pruebas_hash_concurrente(void);
+void pruebas_hash_rcu(void);
+void pruebas_hash_entero(void);
+void pruebas_hash_tipado(void);
+void pruebas_hash_cuco(void);
 
 #ifndef CORRECTOR
 
@@ -25,6 +30,21 @@ int main(int argc, char *argv[]) {
     printf("\n~~~ PRUEBAS CÁTEDRA ~~~\n");
     pruebas_hash_catedra();
 
+    printf("\n~~~ PRUEBAS HASH CONCURRENTE ~~~\n");
+    pruebas_hash_concurrente();
+
+    printf("\n~~~ PRUEBAS HASH RCU ~~~\n");
+    pruebas_hash_rcu();
+
+    printf("\n~~~ PRUEBAS HASH ENTERO ~~~\n");
+    pruebas_hash_entero();
+
+    printf("\n~~~ PRUEBAS HASH TIPADO ~~~\n");
+    pruebas_hash_tipado();
+
+    printf("\n~~~ PRUEBAS HASH CUCO ~~~\n");
+    pruebas_hash_cuco();
+
     return failure_count() > 0;
 }
 
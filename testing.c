@@ -1,5 +1,6 @@
 #include "testing.h"
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <unistd.h> // isatty
 #define ANSI_COLOR_LGH_RED	   "\x1b[1m\x1b[31m"
@@ -27,3 +28,12 @@ void real_print_test(const char* mensaje, bool ok,
 int failure_count() {
 	return _failure_count;
 }
+
+void *crear_claves_prueba(size_t cantidad, size_t largo_clave) {
+	char *claves = malloc(cantidad * largo_clave);
+	if (!claves) return NULL;
+	for (size_t i = 0; i < cantidad; i++) {
+		snprintf(claves + i * largo_clave, largo_clave, i % 2 ? "%08zu" : "clave-larga-%08zu", i);
+	}
+	return claves;
+}
@@ -2,6 +2,7 @@
 #define TESTING_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 // La siguiente macro permite usar sentencias de debug (printf), pero evitando
 // que se impriman en el corrector automático (ver abajo para excepciones). La
@@ -42,6 +43,12 @@ void real_print_test(const char* mensaje, bool ok,
 // Devuelve el número total de errores registrados por print_test().
 int failure_count(void);
 
+// Devuelve un arreglo de 'cantidad' claves de 'largo_clave' bytes cada una,
+// mitad cortas ("00000001") y mitad largas ("clave-larga-00000000"), para usar
+// como char (*claves)[largo_clave]. largo_clave tiene que ser al menos 21.
+// Devuelve NULL si no hay memoria; se libera con free().
+void *crear_claves_prueba(size_t cantidad, size_t largo_clave);
+
 // Valor de DEBUG_PRINT para debug_print().
 #if defined(DEBUG) || !defined(CORRECTOR)
 #define DEBUG_PRINT 1